@@ -0,0 +1,293 @@
+#include "GameCubeControllerAnalytics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+static const char* const HEATMAP_NAMES[ GameCubeControllerAnalytics::HEATMAP_COUNT ] = { "Joystick", "C-Stick" };
+
+static bool IsStickAxis( U32 axis )
+{
+    return axis <= AXIS_C_STICK_Y;
+}
+
+// until an origin is seen the sticks are assumed centered and the triggers released
+static U8 GetNeutralValue( U32 axis )
+{
+    return IsStickAxis( axis ) ? 128 : 0;
+}
+
+// sticks are re-centered on 128, triggers are measured from their resting value. both are clamped
+// to a byte
+static U8 GetRelativeValue( U32 axis, U8 value, U8 origin )
+{
+    int relative = value - origin + GetNeutralValue( axis );
+    return relative < 0 ? 0 : relative > 255 ? 255 : relative;
+}
+
+GameCubeControllerAnalytics::GameCubeControllerAnalytics() : mEnabled( false ), mTables(), mRunState(), mRunLength( 0 )
+{
+    for( U32 i = 0; i < AXIS_COUNT; i++ )
+    {
+        mRunOrigin[ i ] = GetNeutralValue( i );
+    }
+}
+
+void GameCubeControllerAnalytics::Reset( bool enabled )
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+
+    mEnabled = enabled;
+    mTables.mStateCount = 0;
+    for( U32 i = 0; i < HEATMAP_COUNT; i++ )
+    {
+        mTables.mHeatmaps[ i ].assign( enabled ? 256 * 256 : 0, 0 );
+    }
+    for( U32 i = 0; i < HISTOGRAM_COUNT; i++ )
+    {
+        mTables.mHistograms[ i ].assign( enabled ? 256 : 0, 0 );
+    }
+
+    for( U32 i = 0; i < AXIS_COUNT; i++ )
+    {
+        mRunOrigin[ i ] = GetNeutralValue( i );
+    }
+    mRunLength.store( 0, std::memory_order_relaxed );
+}
+
+bool GameCubeControllerAnalytics::IsEnabled() const
+{
+    return mEnabled;
+}
+
+void GameCubeControllerAnalytics::AddState( const JoyBusPacket& packet )
+{
+    if( !mEnabled )
+    {
+        return;
+    }
+
+    // axes the origin doesn't report are measured from their neutral value
+    U8 origin[ AXIS_COUNT ];
+    for( U32 i = 0; i < AXIS_COUNT; i++ )
+    {
+        bool has_origin = packet.mHasOrigin && ( packet.mOrigin.mAxesPresent & ( 1 << i ) );
+        origin[ i ] = has_origin ? packet.mOrigin.mAxes[ i ] : GetNeutralValue( i );
+    }
+
+    U64 length = mRunLength.load( std::memory_order_relaxed );
+    if( length != 0 && memcmp( &packet.mState, &mRunState, sizeof( mRunState ) ) == 0 && memcmp( origin, mRunOrigin, AXIS_COUNT ) == 0 )
+    {
+        mRunLength.store( length + 1, std::memory_order_relaxed );
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock( mMutex );
+
+    AddRun( mTables, length );
+    mRunState = packet.mState;
+    memcpy( mRunOrigin, origin, AXIS_COUNT );
+    mRunLength.store( 1, std::memory_order_relaxed );
+}
+
+// adds length polls of the run's state. the lock has to be held
+void GameCubeControllerAnalytics::AddRun( Tables& tables, U64 length ) const
+{
+    if( length == 0 )
+    {
+        return;
+    }
+
+    tables.mStateCount += length;
+
+    U8 relative[ AXIS_COUNT ];
+    for( U32 i = 0; i < HISTOGRAM_COUNT; i++ )
+    {
+        if( mRunState.mAxesPresent & ( 1 << i ) )
+        {
+            relative[ i ] = GetRelativeValue( i, mRunState.mAxes[ i ], mRunOrigin[ i ] );
+            tables.mHistograms[ i ][ relative[ i ] ] += length;
+        }
+    }
+
+    for( U32 i = 0; i < HEATMAP_COUNT; i++ )
+    {
+        U32 x = AXIS_STICK_X + i * 2;
+        U32 y = x + 1;
+        if( ( mRunState.mAxesPresent & ( 1 << x ) ) && ( mRunState.mAxesPresent & ( 1 << y ) ) )
+        {
+            U32& cell = tables.mHeatmaps[ i ][ relative[ y ] * 256 + relative[ x ] ];
+            cell = length >= 0xFFFFFFFFull - cell ? 0xFFFFFFFF : cell + static_cast<U32>( length );
+        }
+    }
+}
+
+void GameCubeControllerAnalytics::GetTables( Tables& tables, U8* origin )
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+
+    tables = mTables;
+    AddRun( tables, mRunLength.load( std::memory_order_relaxed ) );
+    memcpy( origin, mRunOrigin, AXIS_COUNT );
+}
+
+// only the cells that were hit are written, which keeps the file small for typical captures. stick
+// values are written as a signed offset from the origin
+void GameCubeControllerAnalytics::WriteCsv( GameCubeControllerExportWriter& writer )
+{
+    writer.Write( "Table, Input, X, Y, Count\n" );
+    writer.Write( mEnabled ? "enabled,,,,1\n" : "enabled,,,,0\n" );
+    if( !mEnabled )
+    {
+        return;
+    }
+
+    Tables tables;
+    U8 origin[ AXIS_COUNT ];
+    GetTables( tables, origin );
+
+    writer.Write( "states,,,," );
+    writer.WriteNumber( tables.mStateCount );
+    writer.Write( "\n" );
+
+    for( U32 i = 0; i < AXIS_COUNT; i++ )
+    {
+        writer.Write( "origin," );
+        writer.Write( GAMECUBE_AXIS_NAMES[ i ] );
+        writer.Write( "," );
+        writer.WriteNumber( origin[ i ] );
+        writer.Write( ",,\n" );
+    }
+
+    for( U32 i = 0; i < HISTOGRAM_COUNT; i++ )
+    {
+        int offset = GetNeutralValue( i );
+        for( U32 value = 0; value < 256; value++ )
+        {
+            if( tables.mHistograms[ i ][ value ] != 0 )
+            {
+                writer.Write( "histogram," );
+                writer.Write( GAMECUBE_AXIS_NAMES[ i ] );
+                writer.Write( "," );
+                writer.WriteNumber( int( value ) - offset );
+                writer.Write( ",," );
+                writer.WriteNumber( tables.mHistograms[ i ][ value ] );
+                writer.Write( "\n" );
+            }
+        }
+    }
+
+    for( U32 i = 0; i < HEATMAP_COUNT; i++ )
+    {
+        for( U32 cell = 0; cell < 256 * 256; cell++ )
+        {
+            if( tables.mHeatmaps[ i ][ cell ] != 0 )
+            {
+                writer.Write( "heatmap," );
+                writer.Write( HEATMAP_NAMES[ i ] );
+                writer.Write( "," );
+                writer.WriteNumber( int( cell % 256 ) - 128 );
+                writer.Write( "," );
+                writer.WriteNumber( int( cell / 256 ) - 128 );
+                writer.Write( "," );
+                writer.WriteNumber( tables.mHeatmaps[ i ][ cell ] );
+                writer.Write( "\n" );
+            }
+        }
+    }
+
+    // the lowest and highest value every axis reported, in the units of its histogram
+    for( U32 i = 0; i < HISTOGRAM_COUNT; i++ )
+    {
+        const std::vector<U64>& histogram = tables.mHistograms[ i ];
+        int low = 0;
+        while( low < 256 && histogram[ low ] == 0 )
+        {
+            low++;
+        }
+        if( low == 256 )
+        {
+            continue;
+        }
+        int high = 255;
+        while( histogram[ high ] == 0 )
+        {
+            high--;
+        }
+
+        int offset = GetNeutralValue( i );
+        writer.Write( "range," );
+        writer.Write( GAMECUBE_AXIS_NAMES[ i ] );
+        writer.Write( "," );
+        writer.WriteNumber( low - offset );
+        writer.Write( "," );
+        writer.WriteNumber( high - offset );
+        writer.Write( ",\n" );
+
+        if( !IsStickAxis( i ) )
+        {
+            writer.Write( "travel," );
+            writer.Write( GAMECUBE_AXIS_NAMES[ i ] );
+            writer.Write( "," );
+            writer.WriteNumber( high - low );
+            writer.Write( ",,\n" );
+        }
+    }
+
+    // how far each stick got from its origin in any direction, rounded to a whole step
+    for( U32 i = 0; i < HEATMAP_COUNT; i++ )
+    {
+        double reach = -1;
+        for( U32 cell = 0; cell < 256 * 256; cell++ )
+        {
+            if( tables.mHeatmaps[ i ][ cell ] != 0 )
+            {
+                int x = int( cell % 256 ) - 128;
+                int y = int( cell / 256 ) - 128;
+                reach = std::max( reach, std::sqrt( double( x * x + y * y ) ) );
+            }
+        }
+        if( reach >= 0 )
+        {
+            writer.Write( "reach," );
+            writer.Write( HEATMAP_NAMES[ i ] );
+            writer.Write( "," );
+            writer.WriteNumber( std::lround( reach ) );
+            writer.Write( ",,\n" );
+        }
+    }
+}
+
+void GameCubeControllerAnalytics::WriteBinary( GameCubeControllerExportWriter& writer )
+{
+    writer.Write( "GCAN", 4 );
+    writer.WriteLittleEndian( 2, 4 );
+    writer.WriteLittleEndian( mEnabled ? 1 : 0, 4 );
+    if( !mEnabled )
+    {
+        return;
+    }
+
+    Tables tables;
+    U8 origin[ AXIS_COUNT ];
+    GetTables( tables, origin );
+
+    writer.WriteLittleEndian( tables.mStateCount, 8 );
+    writer.Write( origin, AXIS_COUNT );
+
+    for( U32 i = 0; i < HEATMAP_COUNT; i++ )
+    {
+        for( U32 cell = 0; cell < 256 * 256; cell++ )
+        {
+            writer.WriteLittleEndian( tables.mHeatmaps[ i ][ cell ], 4 );
+        }
+    }
+
+    for( U32 i = 0; i < HISTOGRAM_COUNT; i++ )
+    {
+        for( U32 value = 0; value < 256; value++ )
+        {
+            writer.WriteLittleEndian( tables.mHistograms[ i ][ value ], 8 );
+        }
+    }
+}
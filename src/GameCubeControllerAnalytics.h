@@ -0,0 +1,73 @@
+#ifndef GAMECUBECONTROLLER_ANALYTICS
+#define GAMECUBECONTROLLER_ANALYTICS
+
+#include "GameCubeControllerCommands.h"
+#include "GameCubeControllerExportWriter.h"
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+// accumulates where the sticks and triggers spent their time over a whole capture, for measuring
+// range, dead zones, notches and trigger travel. values are taken relative to the origin the
+// controller last reported, and memory use is fixed no matter how long the capture is
+class GameCubeControllerAnalytics
+{
+  public:
+    enum Heatmap
+    {
+        HEATMAP_STICK,
+        HEATMAP_C_STICK,
+        HEATMAP_COUNT,
+    };
+
+    // the histograms cover the sticks and the analog triggers. the analog a/b buttons are rarely
+    // reported and left out
+    static const U32 HISTOGRAM_COUNT = AXIS_R + 1;
+
+    GameCubeControllerAnalytics();
+
+    // the tables are only allocated while enabled
+    void Reset( bool enabled );
+    bool IsEnabled() const;
+
+    // adds the state of a packet, measured from the packet's origin
+    void AddState( const JoyBusPacket& packet );
+
+    // the counts are followed by the range of every histogram axis, the travel of the triggers and the
+    // furthest each stick reached from its origin
+    void WriteCsv( GameCubeControllerExportWriter& writer );
+    // little endian: "GCAN", U32 version, U32 enabled flag, then if enabled U64 state count, the origin
+    // axes, the heatmaps as 256 x 256 U32 counts indexed [ y ][ x ], then the histograms as 256 U64
+    // counts each
+    void WriteBinary( GameCubeControllerExportWriter& writer );
+
+  protected:
+    struct Tables
+    {
+        U64 mStateCount;
+        // heatmap cells saturate rather than wrap
+        std::vector<U32> mHeatmaps[ HEATMAP_COUNT ];
+        std::vector<U64> mHistograms[ HISTOGRAM_COUNT ];
+    };
+
+    void AddRun( Tables& tables, U64 length ) const;
+    // copies the tables with the current run added, and the origin of the newest poll, so an export can
+    // write them without holding the lock
+    void GetTables( Tables& tables, U8* origin );
+
+    bool mEnabled;
+    Tables mTables;
+
+    // nearly every poll repeats the last one, so identical polls are only counted here, and a run
+    // reaches the tables once a different poll ends it. the state and origin only change under the lock,
+    // the length is written by the worker thread alone
+    GameCubeControllerState mRunState;
+    U8 mRunOrigin[ AXIS_COUNT ];
+    std::atomic<U64> mRunLength;
+
+    // the tables are filled by the worker thread while an export may be reading
+    std::mutex mMutex;
+};
+
+#endif // GAMECUBECONTROLLER_ANALYTICS
@@ -4,8 +4,24 @@
 
 #include <AnalyzerChannelData.h>
 
+// in rolling mode, the longest a run of repeated polls is held back before it's added as a frame
+static const double REPEAT_FLUSH_S = 1.0;
+
 GameCubeControllerAnalyzer::GameCubeControllerAnalyzer()
-    : Analyzer2(), mSettings( new GameCubeControllerAnalyzerSettings() ), mSimulationInitilized( false )
+    : Analyzer2(),
+      mSettings( new GameCubeControllerAnalyzerSettings() ),
+      mSimulationInitilized( false ),
+      mRolling( false ),
+      mHasRepeatFrame( false ),
+      mRepeatType( 0 ),
+      mRepeatData1( 0 ),
+      mRepeatData2( 0 ),
+      mRepeatCount( 0 ),
+      mRepeatStart( 0 ),
+      mRepeatEnd( 0 ),
+      mRepeatFirstBurst( 0 ),
+      mRepeatLastBurst( 0 ),
+      mRepeatFlushSamples( 0 )
 {
     SetAnalyzerSettings( mSettings.get() );
     UseFrameV2();
@@ -28,13 +44,62 @@ void GameCubeControllerAnalyzer::WorkerThread()
     mSampleRateHz = GetSampleRate();
 
     mGamecube = GetAnalyzerChannelData( mSettings->mInputChannel );
+    mEdgeCache.Prepare( mSettings->mInputChannel, mSampleRateHz );
+
+    // the analyzer framework has no way to drop frames, so rolling mode keeps the rate they are added at
+    // down and bounds the tables of its own
+    U64 window_samples = static_cast<U64>( mSettings->mResultsWindowS ) * mSampleRateHz;
+    mRolling = window_samples != 0;
+    mHasRepeatFrame = false;
+    mRepeatCount = 0;
+    mRepeatFlushSamples = static_cast<U64>( REPEAT_FLUSH_S * mSampleRateHz );
+
+    mResults->GetEventIndex().Reset( mSettings->mStickEventThreshold, mSettings->mTriggerEventThreshold, window_samples );
+    mResults->GetAnalytics().Reset( mSettings->mCollectAnalytics );
+    mResults->GetBursts().Reset( mSampleRateHz, mSettings->mVideoFrameRateHz, window_samples );
+    mResults->GetMotorTimeline().Reset( window_samples );
+
+    // the patterns and fields were validated when the settings were applied
+    std::string error;
+    mTrigger.Compile( mSettings->mInputPatterns.c_str(), error );
+    mTrigger.Reset( mSampleRateHz );
+    std::vector<std::string> pattern_texts;
+    for( U32 i = 0; i < mTrigger.GetPatternCount(); i++ )
+    {
+        pattern_texts.push_back( mTrigger.GetPatternText( i ) );
+    }
+    mResults->SetPatternTexts( pattern_texts );
+    mDriftDetector.Reset( mSettings->mDriftThreshold );
+    mHostClassifier.Reset( mSampleRateHz );
+    ParseFrameFields( mSettings->mFrameFields.c_str(), mFrameFields, error );
+    if( mSettings->mNamedButtons )
+    {
+        mFrameFields |= FIELD_NAMED_BUTTONS;
+    }
 
-    AdvanceToEndOfPacket();
+    switch( mSettings->mDevice )
+    {
+    case DEVICE_N64:
+        DecodeLoop<N64Profile>();
+        break;
+    default:
+        DecodeLoop<GameCubeProfile>();
+        break;
+    }
+}
+
+template <class Profile>
+void GameCubeControllerAnalyzer::DecodeLoop()
+{
+    // re-runs after a settings change decode the edges cached by earlier runs before reading the channel
+    GameCubeControllerCachedChannel<AnalyzerChannelData> channel( mGamecube, &mEdgeCache );
+    GameCubeControllerDecoder<GameCubeControllerCachedChannel<AnalyzerChannelData>> decoder( &channel, mSampleRateHz, this );
+    decoder.Start();
 
     while( true )
     {
-        DecodeFrames();
-        ReportProgress( mGamecube->GetSampleNumber() );
+        decoder.template DecodeNext<Profile>();
+        ReportProgress( channel.GetSampleNumber() );
         CheckIfThreadShouldExit();
     }
 }
@@ -81,640 +146,264 @@ void DestroyAnalyzer( Analyzer* analyzer )
     delete analyzer;
 }
 
-U64 GameCubeControllerAnalyzer::GetPulseWidthNs( U64 start_edge, U64 end_edge )
+void GameCubeControllerAnalyzer::OnBit( U64 sample )
 {
-    return static_cast<U64>( ( end_edge - start_edge ) * 1000000000 / mSampleRateHz );
-}
-
-// advances to the rising edge at the end of a packet
-void GameCubeControllerAnalyzer::AdvanceToEndOfPacket()
-{
-    if( mGamecube->GetBitState() == BIT_LOW )
+    // a marker per bit is by far the bulk of the results
+    if( mRolling )
     {
-        mGamecube->AdvanceToNextEdge();
-    }
-
-    // if a complete packet was received successfully, we're already at the end of the packet
-    if( mDecodedReception )
-    {
-        mDecodedReception = false;
         return;
     }
 
-    // otherwise, something was corrupted. synchronize to at least 100us of inactivity.
-    // this way, we can be sure we're at the beginning of a transmission and not in between
-    // a transmission and reception
-    while( GetPulseWidthNs( mGamecube->GetSampleNumber(), mGamecube->GetSampleOfNextEdge() ) < 100000 )
-    {
-        mGamecube->AdvanceToNextEdge();
-        mGamecube->AdvanceToNextEdge();
-    }
+    mResults->AddMarker( sample, AnalyzerResults::Dot, mSettings->mInputChannel );
 }
 
-// advances to the falling edge of the next bit in a packet
-bool GameCubeControllerAnalyzer::AdvanceToNextBitInPacket()
+void GameCubeControllerAnalyzer::OnPacket( const JoyBusPacket& packet, const JoyBusCommandInfo* info, U64 start_sample, U64 end_sample )
 {
-    // if the transmission from the host completed, the controller has ~100us to respond
-    // in this condition, provide the extra leniency
-    int duration = mDecodedTransmission ? 100000 : 5000;
-    mDecodedTransmission = false;
-
-    if( GetPulseWidthNs( mGamecube->GetSampleNumber(), mGamecube->GetSampleOfNextEdge() ) < duration )
+    // the frames of a video frame's polls form one packet, and uninterrupted polling one transaction
+    GameCubeControllerBursts& bursts = mResults->GetBursts();
+    if( bursts.IsNewSession( start_sample ) )
     {
-        mGamecube->AdvanceToNextEdge();
-        return true;
+        FlushRepeatFrame();
+        mHasRepeatFrame = false;
     }
-
-    return false;
-}
-
-void GameCubeControllerAnalyzer::DecodeFrames()
-{
-    // traverse to the first falling edge
-    mGamecube->AdvanceToNextEdge();
-    U64 start_sample = mGamecube->GetSampleNumber();
-
-    U8 cmd, data;
-
-    // try to decode the command
-    if( !DecodeByte( cmd ) )
+    if( bursts.IsNewBurst( start_sample ) )
     {
-        AdvanceToEndOfPacket();
-        return;
+        U64 packet_id = mResults->CommitPacketAndStartNewPacket();
+        mResults->AddPacketToTransaction( bursts.CloseBurst(), packet_id );
     }
+    bursts.AddPacket( packet, start_sample, end_sample );
 
-    bool ok = true;
-    FrameV2 frame_v2;
-    // TODO: delete when FrameV2 supports bubble generation
-    Frame frame;
-    frame.mStartingSampleInclusive = start_sample;
-    frame.mType = cmd;
-
-    // TODO: support more commands, there is a list here: https://n64brew.dev/wiki/Joybus_Protocol
-    switch( cmd )
-    {
-    case JoyBusCommand::CMD_ID:
+    U32 matches = 0;
+    if( packet.mHasState )
     {
-        // command stop bit
-        if( !( AdvanceToNextBitInPacket() && DecodeStopBit() ) )
-        {
-            AdvanceToEndOfPacket();
-            return;
-        }
-        mDecodedTransmission = ok;
+        mResults->GetEventIndex().AddState( start_sample, packet.mState );
+        matches = mTrigger.Evaluate( start_sample, packet.mState );
 
-        // response
-        uint8_t device[ 2 ];
-        if( ok )
-            ok = AdvanceToNextBitInPacket() && DecodeByte( data );
-        if( ok )
+        // origin and recalibrate responses are the origin itself, which the decoder hands on with every
+        // later packet
+        if( packet.mCommand != CMD_ORIGIN && packet.mCommand != CMD_RECALIBRATE )
         {
-            device[ 1 ] = data;
+            mResults->GetAnalytics().AddState( packet );
         }
-        if( ok )
-            ok = AdvanceToNextBitInPacket() && DecodeByte( data );
-        if( ok )
-        {
-            device[ 0 ] = data;
-            frame_v2.AddByteArray( "Device", device, sizeof( device ) );
-        }
-        if( ok )
-            ok = AdvanceToNextBitInPacket() && DecodeByte( data );
-        if( ok )
-        {
-            frame_v2.AddByte( "Status", data );
-        }
-        if( ok )
-            ok = AdvanceToNextBitInPacket() && DecodeStopBit();
-        mDecodedReception = ok;
-        AdvanceToEndOfPacket();
-
-        U64 end_sample = mGamecube->GetSampleNumber();
-        frame.mEndingSampleInclusive = end_sample;
-        mResults->AddFrame( frame );
-        mResults->AddFrameV2( frame_v2, "id", start_sample, end_sample );
-        mResults->CommitResults();
     }
-    break;
 
-    case JoyBusCommand::CMD_STATUS:
+    // only changes of the motor's mode are events
+    JoyBusMotorMode motor_mode;
+    bool motor_changed = false;
+    if( GetJoyBusMotorMode( mSettings->mDevice, packet, motor_mode ) )
     {
-        // command arg1
-        if( !( AdvanceToNextBitInPacket() && DecodeByte( data ) ) )
-        {
-            AdvanceToEndOfPacket();
-            return;
-        }
-        frame_v2.AddByte( "Poll Mode", data );
-        U8 poll_mode = data;
+        motor_changed = mResults->GetMotorTimeline().SetMode( motor_mode, start_sample );
+    }
 
-        // command arg2
-        if( !( AdvanceToNextBitInPacket() && DecodeByte( data ) ) )
-        {
-            AdvanceToEndOfPacket();
-            return;
-        }
-        frame_v2.AddByte( "Motor Mode", data );
+    GameCubeControllerDriftEvent drift_events[ GameCubeControllerDriftDetector::MAX_EVENTS ];
+    U32 drift_event_count = mDriftDetector.AddPacket( packet, drift_events );
 
-        // command stop bit
-        if( !( AdvanceToNextBitInPacket() && DecodeStopBit() ) )
-        {
-            AdvanceToEndOfPacket();
-            return;
-        }
-        mDecodedTransmission = ok;
+    bool fingerprinted = mHostClassifier.AddPacket( packet, start_sample );
 
-        // response
-        uint8_t buttons[ 2 ];
-        if( ok )
-            ok = AdvanceToNextBitInPacket() && DecodeByte( data );
-        if( ok )
-        {
-            buttons[ 1 ] = data;
-        }
-        if( ok )
-            ok = AdvanceToNextBitInPacket() && DecodeByte( data );
-        if( ok )
-        {
-            buttons[ 0 ] = data;
-            frame_v2.AddByteArray( "Buttons", buttons, sizeof( buttons ) );
-        }
-        if( ok )
-            ok = AdvanceToNextBitInPacket() && DecodeByte( data );
-        if( ok )
-        {
-            frame_v2.AddByte( "Joystick X", data );
-        }
-        if( ok )
-            ok = AdvanceToNextBitInPacket() && DecodeByte( data );
-        if( ok )
-        {
-            frame_v2.AddByte( "Joystick Y", data );
-        }
-        if( ok )
-            ok = AdvanceToNextBitInPacket() && DecodeByte( data );
-        if( ok )
-        {
-            if( poll_mode == 1 || poll_mode == 2 )
-            {
-                frame_v2.AddByte( "C-Stick X", data & 0xF0 );
-                frame_v2.AddByte( "C-Stick Y", data & 0x0F );
-            }
-            else
-            {
-                frame_v2.AddByte( "C-Stick X", data );
-            }
-        }
-        if( ok )
-            ok = AdvanceToNextBitInPacket() && DecodeByte( data );
-        if( ok )
-        {
-            if( poll_mode == 1 )
-            {
-                frame_v2.AddByte( "L Analog", data );
-            }
-            else if( poll_mode == 2 )
-            {
-                frame_v2.AddByte( "L Analog", data & 0xF0 );
-                frame_v2.AddByte( "R Analog", data & 0x0F );
-            }
-            else
-            {
-                frame_v2.AddByte( "C-Stick Y", data );
-            }
-        }
-        if( ok )
-            ok = AdvanceToNextBitInPacket() && DecodeByte( data );
-        if( ok )
-        {
-            if( poll_mode == 0 )
-            {
-                frame_v2.AddByte( "L Analog", data & 0xF0 );
-                frame_v2.AddByte( "R Analog", data & 0x0F );
-            }
-            else if( poll_mode == 1 )
-            {
-                frame_v2.AddByte( "R Analog", data );
-            }
-            else if( poll_mode == 2 || poll_mode == 4 )
-            {
-                frame_v2.AddByte( "A Analog", data );
-            }
-            else
-            {
-                frame_v2.AddByte( "L Analog", data );
-            }
-        }
-        if( ok )
-            ok = AdvanceToNextBitInPacket() && DecodeByte( data );
-        if( ok )
-        {
-            if( poll_mode == 0 || poll_mode == 1 )
-            {
-                frame_v2.AddByte( "A Analog", data & 0xF0 );
-                frame_v2.AddByte( "B Analog", data & 0x0F );
-            }
-            else if( poll_mode == 2 || poll_mode == 4 )
-            {
-                frame_v2.AddByte( "B Analog", data );
-            }
-            else
-            {
-                frame_v2.AddByte( "R Analog", data );
-            }
-        }
-
-        if( ok )
-            ok = AdvanceToNextBitInPacket() && DecodeStopBit();
-        mDecodedReception = ok;
-        AdvanceToEndOfPacket();
-
-        U64 end_sample = mGamecube->GetSampleNumber();
-        frame.mEndingSampleInclusive = end_sample;
-        mResults->AddFrame( frame );
-        mResults->AddFrameV2( frame_v2, "status", start_sample, end_sample );
-        mResults->CommitResults();
-    }
-    break;
+    // TODO: delete when FrameV2 supports bubble generation
+    Frame frame;
+    frame.mStartingSampleInclusive = start_sample;
+    frame.mEndingSampleInclusive = end_sample;
+    frame.mType = packet.mCommand;
+    PackFrameContents( packet, frame );
 
-    case JoyBusCommand::CMD_ORIGIN:
+    if( mRolling && packet.mHasState && matches == 0 && !motor_changed && drift_event_count == 0 && !fingerprinted && mHasRepeatFrame &&
+        frame.mType == mRepeatType && frame.mData1 == mRepeatData1 && frame.mData2 == mRepeatData2 )
     {
-        // command stop bit
-        if( !( AdvanceToNextBitInPacket() && DecodeStopBit() ) )
+        if( mRepeatCount == 0 )
         {
-            AdvanceToEndOfPacket();
-            return;
+            mRepeatStart = start_sample;
+            mRepeatFirstBurst = bursts.GetBurstCount();
         }
-        mDecodedTransmission = ok;
+        mRepeatEnd = end_sample;
+        mRepeatLastBurst = bursts.GetBurstCount();
+        mRepeatCount++;
 
-        // response
-        uint8_t buttons[ 2 ];
-        if( ok )
-            ok = AdvanceToNextBitInPacket() && DecodeByte( data );
-        if( ok )
-        {
-            buttons[ 1 ] = data;
-        }
-        if( ok )
-            ok = AdvanceToNextBitInPacket() && DecodeByte( data );
-        if( ok )
-        {
-            buttons[ 0 ] = data;
-            frame_v2.AddByteArray( "Buttons", buttons, sizeof( buttons ) );
-        }
-        if( ok )
-            ok = AdvanceToNextBitInPacket() && DecodeByte( data );
-        if( ok )
-        {
-            frame_v2.AddByte( "Joystick X", data );
-        }
-        if( ok )
-            ok = AdvanceToNextBitInPacket() && DecodeByte( data );
-        if( ok )
-        {
-            frame_v2.AddByte( "Joystick Y", data );
-        }
-        if( ok )
-            ok = AdvanceToNextBitInPacket() && DecodeByte( data );
-        if( ok )
-        {
-            frame_v2.AddByte( "C-Stick X", data );
-        }
-        if( ok )
-            ok = AdvanceToNextBitInPacket() && DecodeByte( data );
-        if( ok )
-        {
-            frame_v2.AddByte( "C-Stick Y", data );
-        }
-        if( ok )
-            ok = AdvanceToNextBitInPacket() && DecodeByte( data );
-        if( ok )
-        {
-            frame_v2.AddByte( "L Analog", data );
-        }
-        if( ok )
-            ok = AdvanceToNextBitInPacket() && DecodeByte( data );
-        if( ok )
-        {
-            frame_v2.AddByte( "R Analog", data );
-        }
-        if( ok )
-            ok = AdvanceToNextBitInPacket() && DecodeByte( data );
-        if( ok )
-        {
-            frame_v2.AddByte( "A Analog", data );
-        }
-        if( ok )
-            ok = AdvanceToNextBitInPacket() && DecodeByte( data );
-        if( ok )
+        // a controller left alone would otherwise show nothing until it's touched again
+        if( mRepeatEnd - mRepeatStart >= mRepeatFlushSamples )
         {
-            frame_v2.AddByte( "B Analog", data );
+            FlushRepeatFrame();
+            mResults->CommitResults();
         }
-
-        if( ok )
-            ok = AdvanceToNextBitInPacket() && DecodeStopBit();
-        mDecodedReception = ok;
-        AdvanceToEndOfPacket();
-
-        U64 end_sample = mGamecube->GetSampleNumber();
-        frame.mEndingSampleInclusive = end_sample;
-        mResults->AddFrame( frame );
-        mResults->AddFrameV2( frame_v2, "origin", start_sample, end_sample );
-        mResults->CommitResults();
+        return;
     }
-    break;
 
+    FlushRepeatFrame();
+    mHasRepeatFrame = packet.mHasState;
+    mRepeatType = frame.mType;
+    mRepeatData1 = frame.mData1;
+    mRepeatData2 = frame.mData2;
 
-    case JoyBusCommand::CMD_RECALIBRATE:
+    // a frame in the idle gap after the packet would have to share samples with the frames around it, so
+    // events are added to the packet frame itself, after the contents repeats are compared by
+    FrameV2 frame_v2;
+    if( info != nullptr )
     {
-        // command arg1
-        if( !( AdvanceToNextBitInPacket() && DecodeByte( data ) ) )
-        {
-            AdvanceToEndOfPacket();
-            return;
-        }
-        frame_v2.AddByte( "Poll Mode", data );
-
-        // command arg2
-        if( !( AdvanceToNextBitInPacket() && DecodeByte( data ) ) )
-        {
-            AdvanceToEndOfPacket();
-            return;
-        }
-        frame_v2.AddByte( "Motor Mode", data );
-
-        // command stop bit
-        if( !( AdvanceToNextBitInPacket() && DecodeStopBit() ) )
-        {
-            AdvanceToEndOfPacket();
-            return;
-        }
-        mDecodedTransmission = ok;
-
-        // response
-        uint8_t buttons[ 2 ];
-        if( ok )
-            ok = AdvanceToNextBitInPacket() && DecodeByte( data );
-        if( ok )
-        {
-            buttons[ 1 ] = data;
-        }
-        if( ok )
-            ok = AdvanceToNextBitInPacket() && DecodeByte( data );
-        if( ok )
-        {
-            buttons[ 0 ] = data;
-            frame_v2.AddByteArray( "Buttons", buttons, sizeof( buttons ) );
-        }
-        if( ok )
-            ok = AdvanceToNextBitInPacket() && DecodeByte( data );
-        if( ok )
-        {
-            frame_v2.AddByte( "Joystick X", data );
-        }
-        if( ok )
-            ok = AdvanceToNextBitInPacket() && DecodeByte( data );
-        if( ok )
-        {
-            frame_v2.AddByte( "Joystick Y", data );
-        }
-        if( ok )
-            ok = AdvanceToNextBitInPacket() && DecodeByte( data );
-        if( ok )
-        {
-            frame_v2.AddByte( "C-Stick X", data );
-        }
-        if( ok )
-            ok = AdvanceToNextBitInPacket() && DecodeByte( data );
-        if( ok )
-        {
-            frame_v2.AddByte( "C-Stick Y", data );
-        }
-        if( ok )
-            ok = AdvanceToNextBitInPacket() && DecodeByte( data );
-        if( ok )
-        {
-            frame_v2.AddByte( "L Analog", data );
-        }
-        if( ok )
-            ok = AdvanceToNextBitInPacket() && DecodeByte( data );
-        if( ok )
-        {
-            frame_v2.AddByte( "R Analog", data );
-        }
-        if( ok )
-            ok = AdvanceToNextBitInPacket() && DecodeByte( data );
-        if( ok )
-        {
-            frame_v2.AddByte( "A Analog", data );
-        }
-        if( ok )
-            ok = AdvanceToNextBitInPacket() && DecodeByte( data );
-        if( ok )
-        {
-            frame_v2.AddByte( "B Analog", data );
-        }
-
-        if( ok )
-            ok = AdvanceToNextBitInPacket() && DecodeStopBit();
-        mDecodedReception = ok;
-        AdvanceToEndOfPacket();
-
-        U64 end_sample = mGamecube->GetSampleNumber();
-        frame.mEndingSampleInclusive = end_sample;
-        mResults->AddFrame( frame );
-        mResults->AddFrameV2( frame_v2, "recalibrate", start_sample, end_sample );
-        mResults->CommitResults();
+        info->mFormat( packet, mFrameFields, frame_v2 );
     }
-    break;
-
-    case JoyBusCommand::CMD_STATUS_LONG:
+    else
     {
-        // command arg1
-        if( !( AdvanceToNextBitInPacket() && DecodeByte( data ) ) )
-        {
-            AdvanceToEndOfPacket();
-            return;
-        }
-        frame_v2.AddByte( "Poll Mode", data );
+        FormatUnknownCommand( packet, frame_v2 );
+    }
+    if( packet.mHasState && packet.mHasOrigin )
+    {
+        AddOriginOffsets( packet.mState, packet.mOrigin, mFrameFields, frame_v2 );
+    }
+    frame_v2.AddInteger( "Burst", bursts.GetBurstCount() );
+    if( packet.mHasResponse )
+    {
+        frame_v2.AddDouble( "Turnaround", static_cast<double>( packet.mResponseStartSample - packet.mCommandEndSample ) / mSampleRateHz );
+    }
+    if( matches != 0 )
+    {
+        AddMatchEvent( matches, end_sample, frame, frame_v2 );
+    }
+    if( motor_changed )
+    {
+        AddMotorEvent( motor_mode, frame, frame_v2 );
+    }
+    if( drift_event_count != 0 )
+    {
+        AddDriftEvents( drift_events, drift_event_count, frame, frame_v2 );
+    }
+    if( fingerprinted )
+    {
+        AddHostEvent( frame, frame_v2 );
+    }
 
-        // command arg2
-        if( !( AdvanceToNextBitInPacket() && DecodeByte( data ) ) )
-        {
-            AdvanceToEndOfPacket();
-            return;
-        }
-        frame_v2.AddByte( "Motor Mode", data );
+    // split packets keep the packet frame for the response, so everything reading controller states from
+    // packet frames works the same either way
+    if( mSettings->mSplitFrames && packet.mHasResponse )
+    {
+        AddCommandFrame( packet, start_sample );
+        frame.mStartingSampleInclusive = packet.mResponseStartSample;
+        frame_v2.AddString( "Direction", "Controller" );
+    }
 
-        // command stop bit
-        if( !( AdvanceToNextBitInPacket() && DecodeStopBit() ) )
-        {
-            AdvanceToEndOfPacket();
-            return;
-        }
-        mDecodedTransmission = ok;
+    mResults->AddFrame( frame );
+    mResults->AddFrameV2( frame_v2, info != nullptr ? info->mFrameType : "unknown", frame.mStartingSampleInclusive, end_sample );
 
-        // response
-        uint8_t buttons[ 2 ];
-        if( ok )
-            ok = AdvanceToNextBitInPacket() && DecodeByte( data );
-        if( ok )
-        {
-            buttons[ 1 ] = data;
-        }
-        if( ok )
-            ok = AdvanceToNextBitInPacket() && DecodeByte( data );
-        if( ok )
-        {
-            buttons[ 0 ] = data;
-            frame_v2.AddByteArray( "Buttons", buttons, sizeof( buttons ) );
-        }
-        if( ok )
-            ok = AdvanceToNextBitInPacket() && DecodeByte( data );
-        if( ok )
-        {
-            frame_v2.AddByte( "Joystick X", data );
-        }
-        if( ok )
-            ok = AdvanceToNextBitInPacket() && DecodeByte( data );
-        if( ok )
-        {
-            frame_v2.AddByte( "Joystick Y", data );
-        }
-        if( ok )
-            ok = AdvanceToNextBitInPacket() && DecodeByte( data );
-        if( ok )
-        {
-            frame_v2.AddByte( "C-Stick X", data );
-        }
-        if( ok )
-            ok = AdvanceToNextBitInPacket() && DecodeByte( data );
-        if( ok )
-        {
-            frame_v2.AddByte( "C-Stick Y", data );
-        }
-        if( ok )
-            ok = AdvanceToNextBitInPacket() && DecodeByte( data );
-        if( ok )
-        {
-            frame_v2.AddByte( "L Analog", data );
-        }
-        if( ok )
-            ok = AdvanceToNextBitInPacket() && DecodeByte( data );
-        if( ok )
-        {
-            frame_v2.AddByte( "R Anlog", data );
-        }
-        if( ok )
-            ok = AdvanceToNextBitInPacket() && DecodeByte( data );
-        if( ok )
-        {
-            frame_v2.AddByte( "A Analog", data );
-        }
-        if( ok )
-            ok = AdvanceToNextBitInPacket() && DecodeByte( data );
-        if( ok )
-        {
-            frame_v2.AddByte( "B Analog", data );
-        }
-
-        if( ok )
-            ok = AdvanceToNextBitInPacket() && DecodeStopBit();
-        mDecodedReception = ok;
-        AdvanceToEndOfPacket();
+    mResults->CommitResults();
+}
 
-        U64 end_sample = mGamecube->GetSampleNumber();
-        frame.mEndingSampleInclusive = end_sample;
-        mResults->AddFrame( frame );
-        mResults->AddFrameV2( frame_v2, "status (long)", start_sample, end_sample );
-        mResults->CommitResults();
-    }
-    break;
+void GameCubeControllerAnalyzer::AddCommandFrame( const JoyBusPacket& packet, U64 start_sample )
+{
+    Frame frame;
+    frame.mStartingSampleInclusive = start_sample;
+    frame.mEndingSampleInclusive = packet.mCommandEndSample;
+    frame.mType = packet.mCommand;
+    PackCommandFrameContents( packet, frame );
+    mResults->AddFrame( frame );
 
-    default:
-        AdvanceToEndOfPacket();
-        break;
+    FrameV2 frame_v2;
+    frame_v2.AddString( "Direction", "Host" );
+    frame_v2.AddByte( "Command", packet.mCommand );
+    if( packet.mArgLength > 0 )
+    {
+        frame_v2.AddByteArray( "Arguments", packet.mArgs, packet.mArgLength );
     }
+    mResults->AddFrameV2( frame_v2, "command", start_sample, packet.mCommandEndSample );
 }
 
-// attempts to decode a byte. the current sample should be a falling edge and this
-// function will return on a rising edge
-bool GameCubeControllerAnalyzer::DecodeByte( U8& byte )
+// marks the packet whose controller state completed input patterns. the bubble names the lowest one
+void GameCubeControllerAnalyzer::AddMatchEvent( U32 matches, U64 end_sample, Frame& frame, FrameV2& frame_v2 )
 {
-    byte = 0;
-    for( U8 i = 0; i < 8; i++ )
-    {
-        bool bit;
-        if( !DecodeDataBit( bit ) )
-        {
-            return false;
-        }
-
-        byte |= bit << ( 7 - i );
+    mResults->AddMarker( end_sample, AnalyzerResults::UpArrow, mSettings->mInputChannel );
 
-        if( i < 7 )
+    std::string text;
+    U32 lowest = GameCubeControllerTrigger::MAX_PATTERNS;
+    for( U32 i = 0; i < GameCubeControllerTrigger::MAX_PATTERNS; i++ )
+    {
+        if( matches & ( 1u << i ) )
         {
-            // advance to the next falling edge iff
-            // - there are more bits to process in the current byte
-            // - the last bit was successful
-            mGamecube->AdvanceToNextEdge();
+            text += ( text.empty() ? "" : "; " ) + mTrigger.GetPatternText( i );
+            lowest = lowest < i ? lowest : i;
         }
     }
 
-    return true;
+    frame.mData2 |= static_cast<U64>( lowest + 1 ) << 40;
+    frame_v2.AddString( "Match", text.c_str() );
 }
 
-// attempts to decode a single bit. on entry, the current sample should be a falling edge and this
-// function will return on a rising edge
-bool GameCubeControllerAnalyzer::DecodeDataBit( bool& bit )
+void GameCubeControllerAnalyzer::AddMotorEvent( JoyBusMotorMode mode, Frame& frame, FrameV2& frame_v2 )
 {
-    U64 starting_sample, ending_sample, rising_edge_sample, falling_edge_sample;
-
-    // determine whether the bit is a 1 or 0 based on the duration of the low time
-    starting_sample = falling_edge_sample = mGamecube->GetSampleNumber();
-    mGamecube->AdvanceToNextEdge();
-    rising_edge_sample = mGamecube->GetSampleNumber();
-
-    U64 low_time = GetPulseWidthNs( falling_edge_sample, rising_edge_sample );
+    frame.mData2 |= ( 1ull << 46 ) | ( static_cast<U64>( mode ) << 47 );
+    frame_v2.AddString( "Motor", JOYBUS_MOTOR_MODE_NAMES[ mode ] );
 
-    if( low_time >= 5000 )
+    GameCubeControllerMotorSpan previous;
+    if( mResults->GetMotorTimeline().GetLastSpan( previous ) )
     {
-        return false;
+        U64 duration = previous.mEndSample - previous.mStartSample;
+        frame_v2.AddString( "Previous Motor Mode", JOYBUS_MOTOR_MODE_NAMES[ previous.mMode ] );
+        frame_v2.AddDouble( "Previous Motor Duration", static_cast<double>( duration ) / mSampleRateHz );
     }
-    else
-    {
-        bit = low_time < 2000;
+}
 
-        // make sure the high time is reasonable. peek at the next falling edge, but don't
-        // actually advance to it yet, in case something is wrong.
-        ending_sample = falling_edge_sample = mGamecube->GetSampleOfNextEdge();
-        U64 high_time = GetPulseWidthNs( rising_edge_sample, falling_edge_sample );
+// the bubble names the first event, the FrameV2 lists them all
+void GameCubeControllerAnalyzer::AddDriftEvents( const GameCubeControllerDriftEvent* events, U32 count, Frame& frame, FrameV2& frame_v2 )
+{
+    frame.mData2 |= ( 1ull << 49 ) | ( static_cast<U64>( events[ 0 ].mType ) << 50 ) | ( static_cast<U64>( events[ 0 ].mAxis ) << 52 );
 
-        if( high_time >= 5000 )
+    std::string text;
+    for( U32 i = 0; i < count; i++ )
+    {
+        text += ( text.empty() ? "" : "; " ) + std::string( GAMECUBE_DRIFT_EVENT_NAMES[ events[ i ].mType ] );
+        if( events[ i ].mAxis < AXIS_COUNT )
         {
-            return false;
+            text += " " + std::string( GAMECUBE_AXIS_NAMES[ events[ i ].mAxis ] ) + ( events[ i ].mOffset >= 0 ? " +" : " " ) +
+                    std::to_string( events[ i ].mOffset );
         }
-
-        // add an indicator showing the bit value
-        U64 middle_sample = ( starting_sample + ending_sample ) / 2;
-        mResults->AddMarker( middle_sample, AnalyzerResults::Dot, mSettings->mInputChannel );
     }
+    frame_v2.AddString( "Drift", text.c_str() );
+}
 
-    return true;
+// adds the host's fingerprint to the poll which completed it
+void GameCubeControllerAnalyzer::AddHostEvent( Frame& frame, FrameV2& frame_v2 )
+{
+    const GameCubeControllerHostProfile& profile = mHostClassifier.GetProfile();
+    frame.mData2 |= ( 1ull << 56 ) | ( static_cast<U64>( profile.mType ) << 57 );
+
+    double rate = mSampleRateHz;
+    frame_v2.AddString( "Host", GAMECUBE_HOST_TYPE_NAMES[ profile.mType ] );
+    frame_v2.AddInteger( "Host Polls", profile.mPolls );
+    // polls all starting on the same sample leave no interval to take a rate from
+    if( profile.mPollInterval != 0 )
+    {
+        frame_v2.AddDouble( "Host Poll Rate", rate / profile.mPollInterval );
+    }
+    frame_v2.AddDouble( "Host Poll Interval", profile.mPollInterval / rate );
+    frame_v2.AddDouble( "Host Min Poll Interval", profile.mMinPollInterval / rate );
+    frame_v2.AddDouble( "Host Max Poll Interval", profile.mMaxPollInterval / rate );
+    frame_v2.AddDouble( "Host Bit Period", profile.mBitPeriod / rate );
+    // a host bit reads as a 1 if its low time is below half a bit
+    frame_v2.AddDouble( "Host Bit Threshold", profile.mBitPeriod / 2 / rate );
+    if( profile.mPollMode < POLL_MODE_COUNT )
+    {
+        frame_v2.AddByte( "Host Poll Mode", profile.mPollMode );
+    }
 }
 
-// attempt to detect a stop bit, which is a single "1" bit where the high time doesn't matter.
-// on entry, the current sample should be a falling edge and this function will return on a rising
-// edge
-bool GameCubeControllerAnalyzer::DecodeStopBit()
+// adds the polls folded into a run so far as one frame
+void GameCubeControllerAnalyzer::FlushRepeatFrame()
 {
-    U64 falling_edge_sample = mGamecube->GetSampleNumber();
-    mGamecube->AdvanceToNextEdge();
-    U64 rising_edge_sample = mGamecube->GetSampleNumber();
+    if( mRepeatCount == 0 )
+    {
+        return;
+    }
 
-    U64 low_time = GetPulseWidthNs( falling_edge_sample, rising_edge_sample );
+    Frame frame;
+    frame.mStartingSampleInclusive = mRepeatStart;
+    frame.mEndingSampleInclusive = mRepeatEnd;
+    frame.mType = mRepeatType;
+    frame.mData1 = mRepeatCount;
+    frame.mData2 = FRAME_REPEAT;
+    mResults->AddFrame( frame );
+
+    FrameV2 frame_v2;
+    frame_v2.AddInteger( "Count", mRepeatCount );
+    frame_v2.AddInteger( "First Burst", mRepeatFirstBurst );
+    frame_v2.AddInteger( "Last Burst", mRepeatLastBurst );
+    mResults->AddFrameV2( frame_v2, "repeat", mRepeatStart, mRepeatEnd );
 
-    // after observing an OEM controller, the low-time of a stop bit tended to be more than an
-    // average "1" but less than a "0". therefore, we add a bit of leniency.
-    return low_time < 2500;
+    mRepeatCount = 0;
 }
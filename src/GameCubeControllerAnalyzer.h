@@ -2,23 +2,20 @@
 #define GAMECUBECONTROLLER_ANALYZER_H
 
 #include "GameCubeControllerAnalyzerResults.h"
+#include "GameCubeControllerCommands.h"
+#include "GameCubeControllerDecoder.h"
+#include "GameCubeControllerDrift.h"
+#include "GameCubeControllerHost.h"
+#include "GameCubeControllerEdgeCache.h"
 #include "GameCubeControllerSimulationDataGenerator.h"
+#include "GameCubeControllerTrigger.h"
 
 #include <Analyzer.h>
 
 class GameCubeControllerAnalyzerSettings;
-class ANALYZER_EXPORT GameCubeControllerAnalyzer : public Analyzer2
+class ANALYZER_EXPORT GameCubeControllerAnalyzer : public Analyzer2, public GameCubeControllerDecoderSink
 {
   public:
-    enum JoyBusCommand
-    {
-        CMD_ID = 0x00,
-        CMD_STATUS = 0x40,
-        CMD_ORIGIN = 0x41,
-        CMD_RECALIBRATE = 0x42,
-        CMD_STATUS_LONG = 0x43,
-    };
-
     GameCubeControllerAnalyzer();
     virtual ~GameCubeControllerAnalyzer();
 
@@ -31,25 +28,49 @@ class ANALYZER_EXPORT GameCubeControllerAnalyzer : public Analyzer2
     virtual const char* GetAnalyzerName() const;
     virtual bool NeedsRerun();
 
+    virtual void OnBit( U64 sample );
+    virtual void OnPacket( const JoyBusPacket& packet, const JoyBusCommandInfo* info, U64 start_sample, U64 end_sample );
+
   protected: // vars
     std::auto_ptr<GameCubeControllerAnalyzerSettings> mSettings;
     std::auto_ptr<GameCubeControllerAnalyzerResults> mResults;
     AnalyzerChannelData* mGamecube;
+    GameCubeControllerEdgeCache mEdgeCache;
 
     GameCubeControllerSimulationDataGenerator mSimulationDataGenerator;
     bool mSimulationInitilized;
 
     U32 mSampleRateHz;
-    bool mDecodedTransmission = false;
-    bool mDecodedReception = false;
-
-    U64 GetPulseWidthNs( U64 start_edge, U64 end_edge );
-    void AdvanceToEndOfPacket();
-    bool AdvanceToNextBitInPacket();
-    void DecodeFrames();
-    bool DecodeByte( U8& byte );
-    bool DecodeDataBit( bool& bit );
-    bool DecodeStopBit();
+
+    GameCubeControllerTrigger mTrigger;
+    GameCubeControllerDriftDetector mDriftDetector;
+    GameCubeControllerHostClassifier mHostClassifier;
+    // the FIELD_ mask of the controller state fields added to packet frames
+    U32 mFrameFields;
+
+    // rolling mode, for long monitoring runs. a run of polls with the same command and packed contents as
+    // the last packet frame within one session is only added once it ends, or after a while. runs
+    // cross video frames, as consoles usually poll once per frame
+    bool mRolling;
+    bool mHasRepeatFrame;
+    U8 mRepeatType;
+    U64 mRepeatData1;
+    U64 mRepeatData2;
+    U64 mRepeatCount;
+    U64 mRepeatStart;
+    U64 mRepeatEnd;
+    U64 mRepeatFirstBurst;
+    U64 mRepeatLastBurst;
+    U64 mRepeatFlushSamples;
+
+    template <class Profile>
+    void DecodeLoop();
+    void AddCommandFrame( const JoyBusPacket& packet, U64 start_sample );
+    void AddMatchEvent( U32 matches, U64 end_sample, Frame& frame, FrameV2& frame_v2 );
+    void AddMotorEvent( JoyBusMotorMode mode, Frame& frame, FrameV2& frame_v2 );
+    void AddDriftEvents( const GameCubeControllerDriftEvent* events, U32 count, Frame& frame, FrameV2& frame_v2 );
+    void AddHostEvent( Frame& frame, FrameV2& frame_v2 );
+    void FlushRepeatFrame();
 };
 
 extern "C" ANALYZER_EXPORT const char* __cdecl GetAnalyzerName();
@@ -2,103 +2,858 @@
 
 #include "GameCubeControllerAnalyzer.h"
 #include "GameCubeControllerAnalyzerSettings.h"
+#include "GameCubeControllerDrift.h"
+#include "GameCubeControllerHost.h"
+#include "GameCubeControllerExportWriter.h"
 
 #include <AnalyzerHelpers.h>
+#include <cstdio>
 #include <fstream>
 #include <iostream>
+#include <vector>
 
 GameCubeControllerAnalyzerResults::GameCubeControllerAnalyzerResults( GameCubeControllerAnalyzer* analyzer,
                                                                       GameCubeControllerAnalyzerSettings* settings )
-    : AnalyzerResults(), mSettings( settings ), mAnalyzer( analyzer )
+    : AnalyzerResults(), mSettings( settings ), mAnalyzer( analyzer ), mTextCache( TEXT_CACHE_SIZE )
 {
+    for( U32 i = 0; i < TEXT_CACHE_SIZE; i++ )
+    {
+        mTextCache[ i ].mFrameIndex = INVALID_RESULT_INDEX;
+    }
 }
 
 GameCubeControllerAnalyzerResults::~GameCubeControllerAnalyzerResults()
 {
 }
 
-void GameCubeControllerAnalyzerResults::GenerateBubbleText( U64 frame_index, Channel& channel, DisplayBase display_base )
+void PackFrameContents( const JoyBusPacket& packet, Frame& frame )
+{
+    frame.mData1 = 0;
+    frame.mData2 = FRAME_PACKET;
+
+    if( packet.mHasState )
+    {
+        const GameCubeControllerState& state = packet.mState;
+        frame.mData1 = state.mButtons[ 0 ] | ( state.mButtons[ 1 ] << 8 );
+        for( U32 i = 0; i < 6; i++ )
+        {
+            frame.mData1 |= static_cast<U64>( state.mAxes[ i ] ) << ( 16 + i * 8 );
+        }
+        frame.mData2 |= ( 1 << 8 ) | ( state.mAxesPresent << 16 ) | ( static_cast<U64>( state.mAxes[ 6 ] ) << 24 ) |
+                        ( static_cast<U64>( state.mAxes[ 7 ] ) << 32 );
+    }
+    else
+    {
+        U32 length = packet.mResponseLength < 8 ? packet.mResponseLength : 8;
+        for( U32 i = 0; i < length; i++ )
+        {
+            frame.mData1 |= static_cast<U64>( packet.mResponse[ i ] ) << ( i * 8 );
+        }
+        frame.mData2 |= length << 16;
+    }
+}
+
+void PackCommandFrameContents( const JoyBusPacket& packet, Frame& frame )
+{
+    U32 length = packet.mArgLength < 8 ? packet.mArgLength : 8;
+    frame.mData1 = 0;
+    for( U32 i = 0; i < length; i++ )
+    {
+        frame.mData1 |= static_cast<U64>( packet.mArgs[ i ] ) << ( i * 8 );
+    }
+    frame.mData2 = FRAME_COMMAND | ( length << 16 );
+}
+
+GameCubeControllerFrameKind GetFrameKind( const Frame& frame )
+{
+    return static_cast<GameCubeControllerFrameKind>( frame.mData2 & 0xFF );
+}
+
+bool UnpackFrameState( const Frame& frame, GameCubeControllerState& state )
+{
+    if( GetFrameKind( frame ) != FRAME_PACKET || !( frame.mData2 & ( 1 << 8 ) ) )
+    {
+        return false;
+    }
+
+    state.mButtons[ 0 ] = frame.mData1 & 0xFF;
+    state.mButtons[ 1 ] = ( frame.mData1 >> 8 ) & 0xFF;
+    for( U32 i = 0; i < 6; i++ )
+    {
+        state.mAxes[ i ] = ( frame.mData1 >> ( 16 + i * 8 ) ) & 0xFF;
+    }
+    state.mAxes[ 6 ] = ( frame.mData2 >> 24 ) & 0xFF;
+    state.mAxes[ 7 ] = ( frame.mData2 >> 32 ) & 0xFF;
+    state.mAxesPresent = ( frame.mData2 >> 16 ) & 0xFF;
+
+    return true;
+}
+
+U32 UnpackFrameResponse( const Frame& frame, U8* response )
+{
+    if( ( GetFrameKind( frame ) != FRAME_PACKET && GetFrameKind( frame ) != FRAME_COMMAND ) || ( frame.mData2 & ( 1 << 8 ) ) )
+    {
+        return 0;
+    }
+
+    U32 length = ( frame.mData2 >> 16 ) & 0xFF;
+    for( U32 i = 0; i < length; i++ )
+    {
+        response[ i ] = ( frame.mData1 >> ( i * 8 ) ) & 0xFF;
+    }
+
+    return length;
+}
+
+static std::string FormatNumber( U64 number, DisplayBase display_base, U32 num_data_bits )
+{
+    char number_str[ 128 ];
+    AnalyzerHelpers::GetNumberString( number, display_base, num_data_bits, number_str, 128 );
+    return number_str;
+}
+
+void GameCubeControllerAnalyzerResults::FormatFrameStrings( const Frame& frame, DisplayBase display_base, std::vector<std::string>& strings )
+{
+    strings.clear();
+
+    const JoyBusCommandInfo* info = GetJoyBusCommandInfo( mSettings->mDevice, frame.mType );
+    std::string name = info != nullptr ? info->mName : "Unknown " + FormatNumber( frame.mType, display_base, 8 );
+
+    if( GetFrameKind( frame ) == FRAME_REPEAT )
+    {
+        strings.push_back( "R" );
+        strings.push_back( "Repeat" );
+        strings.push_back( name + " repeated " + std::to_string( frame.mData1 ) + " times" );
+        return;
+    }
+
+    if( GetFrameKind( frame ) == FRAME_COMMAND )
+    {
+        strings.push_back( "C" );
+        strings.push_back( name );
+
+        U8 args[ 8 ];
+        U32 length = UnpackFrameResponse( frame, args );
+        std::string text = name + " command";
+        for( U32 i = 0; i < length; i++ )
+        {
+            text += " " + FormatNumber( args[ i ], display_base, 8 );
+        }
+        strings.push_back( text );
+        return;
+    }
+
+    strings.push_back( name.substr( 0, 1 ) );
+    strings.push_back( name );
+
+    GameCubeControllerState state;
+    if( UnpackFrameState( frame, state ) )
+    {
+        // the error and origin bits aren't inputs, leave them out
+        static const U16 input_buttons = 0x7F1F;
+        U16 buttons = ( state.mButtons[ 0 ] | ( state.mButtons[ 1 ] << 8 ) ) & input_buttons;
+
+        std::string text = name;
+        for( U32 i = 0; i < BUTTON_COUNT; i++ )
+        {
+            if( buttons & ( 1 << i ) )
+            {
+                text += ( text.size() == name.size() ? " " : "+" );
+                text += GAMECUBE_BUTTON_NAMES[ i ];
+            }
+        }
+        if( buttons != 0 )
+        {
+            strings.push_back( text );
+        }
+
+        static const char* const labels[ AXIS_COUNT ] = { " X:", " Y:", " CX:", " CY:", " L:", " R:", " A:", " B:" };
+        for( U32 i = 0; i < AXIS_COUNT; i++ )
+        {
+            if( state.mAxesPresent & ( 1 << i ) )
+            {
+                text += labels[ i ] + FormatNumber( state.mAxes[ i ], display_base, 8 );
+            }
+
+            // the main stick is the most useful, so offer it on its own before everything else
+            if( i == AXIS_STICK_Y || i == AXIS_COUNT - 1 )
+            {
+                strings.push_back( text );
+            }
+        }
+    }
+    else
+    {
+        U8 response[ 8 ];
+        U32 length = UnpackFrameResponse( frame, response );
+        if( length > 0 )
+        {
+            std::string text = name;
+            for( U32 i = 0; i < length; i++ )
+            {
+                text += " " + FormatNumber( response[ i ], display_base, 8 );
+            }
+            strings.push_back( text );
+        }
+    }
+
+    AppendFrameEvents( frame, strings );
+}
+
+// events only make the longest text longer, so the shorter ones still fit small bubbles
+void GameCubeControllerAnalyzerResults::AppendFrameEvents( const Frame& frame, std::vector<std::string>& strings )
+{
+    std::string events;
+
+    U32 pattern = ( frame.mData2 >> 40 ) & 0x3F;
+    if( pattern != 0 )
+    {
+        std::lock_guard<std::mutex> lock( mPatternTextsMutex );
+        if( pattern <= mPatternTexts.size() )
+        {
+            events += ", match " + mPatternTexts[ pattern - 1 ];
+        }
+    }
+
+    if( frame.mData2 & ( 1ull << 46 ) )
+    {
+        events += ", motor " + std::string( JOYBUS_MOTOR_MODE_NAMES[ ( ( frame.mData2 >> 47 ) & 0x3 ) % MOTOR_MODE_COUNT ] );
+    }
+
+    if( frame.mData2 & ( 1ull << 49 ) )
+    {
+        events += ", " + std::string( GAMECUBE_DRIFT_EVENT_NAMES[ ( frame.mData2 >> 50 ) & 0x3 ] );
+        U32 axis = ( frame.mData2 >> 52 ) & 0xF;
+        if( axis < AXIS_COUNT )
+        {
+            events += " " + std::string( GAMECUBE_AXIS_NAMES[ axis ] );
+        }
+    }
+
+    if( frame.mData2 & ( 1ull << 56 ) )
+    {
+        events += ", host " + std::string( GAMECUBE_HOST_TYPE_NAMES[ ( frame.mData2 >> 57 ) & 0x3 ] );
+    }
+
+    if( !events.empty() )
+    {
+        strings.push_back( strings.back() + " [" + events.substr( 2 ) + "]" );
+    }
+}
+
+// must be called with mTextCacheMutex held
+const std::vector<std::string>& GameCubeControllerAnalyzerResults::GetCachedFrameStrings( U64 frame_index, DisplayBase display_base )
+{
+    TextCacheEntry& entry = mTextCache[ frame_index % TEXT_CACHE_SIZE ];
+    if( entry.mFrameIndex != frame_index || entry.mDisplayBase != display_base )
+    {
+        FormatFrameStrings( GetFrame( frame_index ), display_base, entry.mStrings );
+        entry.mFrameIndex = frame_index;
+        entry.mDisplayBase = display_base;
+    }
+
+    return entry.mStrings;
+}
+
+void GameCubeControllerAnalyzerResults::GenerateBubbleText( U64 frame_index, Channel&, DisplayBase display_base )
 {
     ClearResultStrings();
-    Frame frame = GetFrame( frame_index );
 
-    switch( frame.mType )
+    std::lock_guard<std::mutex> lock( mTextCacheMutex );
+    const std::vector<std::string>& strings = GetCachedFrameStrings( frame_index, display_base );
+    for( size_t i = 0; i < strings.size(); i++ )
     {
-    case GameCubeControllerAnalyzer::JoyBusCommand::CMD_ID:
-        AddResultString( "ID" );
-        break;
+        AddResultString( strings[ i ].c_str() );
+    }
+}
 
-    case GameCubeControllerAnalyzer::JoyBusCommand::CMD_STATUS:
-        AddResultString( "Status" );
+void GameCubeControllerAnalyzerResults::GenerateExportFile( const char* file, DisplayBase display_base, U32 export_type_user_id )
+{
+    switch( export_type_user_id )
+    {
+    case GameCubeControllerAnalyzerSettings::EXPORT_INPUT_EVENTS:
+        ExportInputEvents( file );
         break;
-
-    case GameCubeControllerAnalyzer::JoyBusCommand::CMD_ORIGIN:
-        AddResultString( "Origin" );
+    case GameCubeControllerAnalyzerSettings::EXPORT_ANALYTICS:
+        ExportAnalytics( file, false );
         break;
-
-    case GameCubeControllerAnalyzer::JoyBusCommand::CMD_RECALIBRATE:
-        AddResultString( "Recalibrate" );
+    case GameCubeControllerAnalyzerSettings::EXPORT_ANALYTICS_BINARY:
+        ExportAnalytics( file, true );
         break;
-
-    case GameCubeControllerAnalyzer::JoyBusCommand::CMD_STATUS_LONG:
-        AddResultString( "Status Long" );
+    case GameCubeControllerAnalyzerSettings::EXPORT_RESAMPLED:
+        ExportResampledStates( file, display_base, false );
+        break;
+    case GameCubeControllerAnalyzerSettings::EXPORT_RESAMPLED_BINARY:
+        ExportResampledStates( file, display_base, true );
+        break;
+    case GameCubeControllerAnalyzerSettings::EXPORT_DOLPHIN_MOVIE:
+        ExportDolphinMovie( file );
+        break;
+    case GameCubeControllerAnalyzerSettings::EXPORT_BURSTS:
+        ExportBursts( file );
+        break;
+    case GameCubeControllerAnalyzerSettings::EXPORT_MOTOR:
+        ExportMotorTimeline( file );
         break;
-
     default:
+        ExportFrames( file, display_base );
         break;
     }
 }
 
-void GameCubeControllerAnalyzerResults::GenerateExportFile( const char* file, DisplayBase display_base, U32 export_type_user_id )
+void GameCubeControllerAnalyzerResults::ExportFrames( const char* file, DisplayBase display_base )
 {
-    std::ofstream file_stream( file, std::ios::out );
+    GameCubeControllerExportWriter writer( file );
 
     U64 trigger_sample = mAnalyzer->GetTriggerSample();
     U32 sample_rate = mAnalyzer->GetSampleRate();
 
-    file_stream << "Time [s], Value [0, 1]" << std::endl;
+    writer.Write( "Time [s], Contents\n" );
 
-    U64 num_frames = GetNumFrames();
-    for( U32 i = 0; i < num_frames; i++ )
+    // formatting the text is most of the work, so it's spread over every core
+    GameCubeControllerExportPipeline pipeline(
+        this, [this, display_base, trigger_sample, sample_rate]( GameCubeControllerExportPipeline::Chunk& chunk ) {
+            FormatFrameRows( chunk, display_base, trigger_sample, sample_rate );
+        } );
+    pipeline.Run( GetNumFrames(), writer );
+
+    writer.Close();
+}
+
+void GameCubeControllerAnalyzerResults::FormatFrameRows( GameCubeControllerExportPipeline::Chunk& chunk, DisplayBase display_base,
+                                                         U64 trigger_sample, U32 sample_rate )
+{
+    std::vector<std::string> strings;
+    for( size_t i = 0; i < chunk.mFrames.size(); i++ )
     {
-        Frame frame = GetFrame( i );
+        const Frame& frame = chunk.mFrames[ i ];
 
         char time_str[ 128 ];
         AnalyzerHelpers::GetTimeString( frame.mStartingSampleInclusive, trigger_sample, sample_rate, time_str, 128 );
 
-        char number_str[ 128 ];
-        AnalyzerHelpers::GetNumberString( frame.mData1, display_base, 8, number_str, 128 );
-
-        file_stream << time_str << "," << number_str << std::endl;
+        FormatFrameStrings( frame, display_base, strings );
 
-        if( UpdateExportProgressAndCheckForCancel( i, num_frames ) == true )
-        {
-            file_stream.close();
-            return;
-        }
+        chunk.mText += time_str;
+        chunk.mText += ",";
+        chunk.mText += strings.back();
+        chunk.mText += "\n";
     }
-
-    file_stream.close();
 }
 
 void GameCubeControllerAnalyzerResults::GenerateFrameTabularText( U64 frame_index, DisplayBase display_base )
 {
 #ifdef SUPPORTS_PROTOCOL_SEARCH
-    Frame frame = GetFrame( frame_index );
     ClearTabularText();
 
-    char number_str[ 128 ];
-    AnalyzerHelpers::GetNumberString( frame.mData1, display_base, 8, number_str, 128 );
-    AddTabularText( number_str );
+    std::lock_guard<std::mutex> lock( mTextCacheMutex );
+    AddTabularText( GetCachedFrameStrings( frame_index, display_base ).back().c_str() );
 #endif
 }
 
+static std::string FormatMicroseconds( U64 samples, U32 sample_rate )
+{
+    char text[ 32 ];
+    snprintf( text, sizeof( text ), "%.1f", samples * 1000000.0 / sample_rate );
+    return text;
+}
+
+// packets are the bursts of polls making up one video frame
 void GameCubeControllerAnalyzerResults::GeneratePacketTabularText( U64 packet_id, DisplayBase display_base )
 {
-    // not supported
+#ifdef SUPPORTS_PROTOCOL_SEARCH
+    ClearTabularText();
+
+    GameCubeControllerBurst burst;
+    if( !mBursts.GetBurst( packet_id, burst ) )
+    {
+        return;
+    }
+
+    U32 sample_rate = mAnalyzer->GetSampleRate();
+    std::string text = "Frame " + std::to_string( packet_id ) + ": " + std::to_string( burst.mPolls ) + " polls, " +
+                       std::to_string( burst.mStateChanges ) + " changed";
+    if( burst.mPolls > 0 )
+    {
+        text += ", " + FormatMicroseconds( burst.mMinLatency, sample_rate ) + "-";
+        text += FormatMicroseconds( burst.mMaxLatency, sample_rate ) + " us";
+    }
+    AddTabularText( text.c_str() );
+#endif
 }
 
+// transactions are sessions of uninterrupted polling
 void GameCubeControllerAnalyzerResults::GenerateTransactionTabularText( U64 transaction_id, DisplayBase display_base )
 {
-    // not supported
-}
\ No newline at end of file
+#ifdef SUPPORTS_PROTOCOL_SEARCH
+    ClearTabularText();
+
+    GameCubeControllerSession session;
+    if( !mBursts.GetSession( static_cast<U32>( transaction_id ), session ) )
+    {
+        return;
+    }
+
+    U32 sample_rate = mAnalyzer->GetSampleRate();
+    char duration[ 32 ];
+    snprintf( duration, sizeof( duration ), "%.3f", ( session.mEndSample - session.mStartSample ) / double( sample_rate ) );
+
+    // button presses come from the event index, which only holds the ones within its window
+    U64 presses = 0;
+    for( U32 i = 0; i < BUTTON_COUNT; i++ )
+    {
+        presses += mEventIndex.Count( i, true, session.mStartSample, session.mEndSample + 1 );
+    }
+
+    std::string text = "Session " + std::to_string( transaction_id ) + ": " + std::to_string( session.mBurstCount ) + " frames, " +
+                       std::to_string( session.mPolls ) + " polls, " + std::to_string( session.mStateChanges ) + " changed, " +
+                       std::to_string( presses ) + " presses, " + duration + " s";
+    if( session.mPolls > 0 )
+    {
+        text += ", " + FormatMicroseconds( session.mMinLatency, sample_rate ) + "-";
+        text += FormatMicroseconds( session.mMaxLatency, sample_rate ) + " us, median ";
+        text += FormatMicroseconds( mBursts.GetLatencyPercentile( session, 0.5 ), sample_rate ) + " us, 99% ";
+        text += FormatMicroseconds( mBursts.GetLatencyPercentile( session, 0.99 ), sample_rate ) + " us";
+    }
+    AddTabularText( text.c_str() );
+#endif
+}
+
+GameCubeControllerEventIndex& GameCubeControllerAnalyzerResults::GetEventIndex()
+{
+    return mEventIndex;
+}
+
+GameCubeControllerAnalytics& GameCubeControllerAnalyzerResults::GetAnalytics()
+{
+    return mAnalytics;
+}
+
+GameCubeControllerBursts& GameCubeControllerAnalyzerResults::GetBursts()
+{
+    return mBursts;
+}
+
+GameCubeControllerMotorTimeline& GameCubeControllerAnalyzerResults::GetMotorTimeline()
+{
+    return mMotorTimeline;
+}
+
+void GameCubeControllerAnalyzerResults::SetPatternTexts( const std::vector<std::string>& texts )
+{
+    std::lock_guard<std::mutex> lock( mPatternTextsMutex );
+    mPatternTexts = texts;
+}
+
+void GameCubeControllerAnalyzerResults::ExportAnalytics( const char* file, bool binary )
+{
+    GameCubeControllerExportWriter writer( file, binary );
+
+    if( binary )
+    {
+        mAnalytics.WriteBinary( writer );
+    }
+    else
+    {
+        mAnalytics.WriteCsv( writer );
+    }
+
+    UpdateExportProgressAndCheckForCancel( 1, 1 );
+    writer.Close();
+}
+
+// writes the controller state on a fixed time grid, holding the last reported value of every input
+// between polls. frames are visited once in order, so memory use doesn't depend on the capture length.
+// the binary format is "GCRS", U32 version, U32 rate, U32 sample rate, S64 first sample relative to
+// the trigger, followed by one 11-byte state per grid point laid out like the "State" field
+void GameCubeControllerAnalyzerResults::ExportResampledStates( const char* file, DisplayBase display_base, bool binary )
+{
+    GameCubeControllerExportWriter writer( file, binary );
+
+    U64 trigger_sample = mAnalyzer->GetTriggerSample();
+    U32 sample_rate = mAnalyzer->GetSampleRate();
+    U32 rate = mSettings->mResampleRateHz;
+
+    if( !binary )
+    {
+        writer.Write( "Time [s], Buttons" );
+        for( U32 i = 0; i < AXIS_COUNT; i++ )
+        {
+            writer.Write( ", " );
+            writer.Write( GAMECUBE_AXIS_NAMES[ i ] );
+        }
+        writer.Write( "\n" );
+    }
+
+    GameCubeControllerState held = {};
+    bool has_state = false;
+    U64 first_sample = 0;
+    U64 next_sample = 0;
+    U64 grid_index = 0;
+
+    U64 num_frames = GetNumFrames();
+    for( U64 i = 0; i <= num_frames; i++ )
+    {
+        // one pass past the last frame flushes the grid points up to the end of the final packet
+        GameCubeControllerState state;
+        U64 sample;
+        if( i < num_frames )
+        {
+            Frame frame = GetFrame( i );
+            if( !UnpackFrameState( frame, state ) )
+            {
+                continue;
+            }
+            sample = frame.mStartingSampleInclusive;
+        }
+        else
+        {
+            sample = num_frames > 0 ? GetFrame( num_frames - 1 ).mEndingSampleInclusive + 1 : 0;
+        }
+
+        if( !has_state )
+        {
+            if( i == num_frames )
+            {
+                break;
+            }
+
+            has_state = true;
+            first_sample = next_sample = sample;
+
+            if( binary )
+            {
+                writer.Write( "GCRS", 4 );
+                writer.WriteLittleEndian( 1, 4 );
+                writer.WriteLittleEndian( rate, 4 );
+                writer.WriteLittleEndian( sample_rate, 4 );
+                writer.WriteLittleEndian( static_cast<S64>( first_sample - trigger_sample ), 8 );
+            }
+        }
+
+        while( next_sample < sample )
+        {
+            if( binary )
+            {
+                writer.Write( &held, sizeof( held ) );
+            }
+            else
+            {
+                char time_str[ 128 ];
+                AnalyzerHelpers::GetTimeString( next_sample, trigger_sample, sample_rate, time_str, 128 );
+
+                char number_str[ 128 ];
+                AnalyzerHelpers::GetNumberString( held.mButtons[ 0 ] | ( held.mButtons[ 1 ] << 8 ), display_base, 16, number_str, 128 );
+
+                writer.Write( time_str );
+                writer.Write( "," );
+                writer.Write( number_str );
+                for( U32 axis = 0; axis < AXIS_COUNT; axis++ )
+                {
+                    writer.Write( "," );
+                    if( held.mAxesPresent & ( 1 << axis ) )
+                    {
+                        writer.WriteNumber( held.mAxes[ axis ] );
+                    }
+                }
+                writer.Write( "\n" );
+            }
+
+            // split the multiplication so long captures at high sample rates can't overflow
+            grid_index++;
+            next_sample = first_sample + grid_index / rate * sample_rate + grid_index % rate * sample_rate / rate;
+        }
+
+        if( i == num_frames )
+        {
+            break;
+        }
+
+        // axes the poll mode didn't report keep their last value
+        held.mButtons[ 0 ] = state.mButtons[ 0 ];
+        held.mButtons[ 1 ] = state.mButtons[ 1 ];
+        for( U32 axis = 0; axis < AXIS_COUNT; axis++ )
+        {
+            if( state.mAxesPresent & ( 1 << axis ) )
+            {
+                held.mAxes[ axis ] = state.mAxes[ axis ];
+            }
+        }
+        held.mAxesPresent |= state.mAxesPresent;
+
+        if( UpdateExportProgressAndCheckForCancel( i, num_frames ) == true )
+        {
+            return;
+        }
+    }
+}
+
+// dolphin's movie header. only the fields needed for playback are filled in, everything else is left
+// zero so dolphin keeps its current configuration
+static const U32 DTM_HEADER_SIZE = 256;
+static const U32 DTM_CONTROLLERS_OFFSET = 0x0B;
+static const U32 DTM_FRAME_COUNT_OFFSET = 0x0D;
+static const U32 DTM_INPUT_COUNT_OFFSET = 0x15;
+
+// converts a state to dolphin's 8-byte ControllerState: button bits, then L/R, main stick and c-stick
+static void PackDolphinState( const GameCubeControllerState& state, U8* dtm )
+{
+    static const struct
+    {
+        U8 mButton;
+        U8 mBit;
+    } buttons[] = {
+        { 4, 0 },  { 0, 1 },  { 1, 2 },  { 2, 3 },  { 3, 4 },  { 12, 5 }, { 11, 6 },
+        { 10, 7 }, { 8, 8 },  { 9, 9 },  { 14, 10 }, { 13, 11 },
+    };
+
+    U16 in = state.mButtons[ 0 ] | ( state.mButtons[ 1 ] << 8 );
+
+    // every state comes from a response, so the controller is connected
+    U16 out = 1 << 14;
+    for( U32 i = 0; i < sizeof( buttons ) / sizeof( buttons[ 0 ] ); i++ )
+    {
+        if( in & ( 1 << buttons[ i ].mButton ) )
+        {
+            out |= 1 << buttons[ i ].mBit;
+        }
+    }
+
+    dtm[ 0 ] = out & 0xFF;
+    dtm[ 1 ] = out >> 8;
+    dtm[ 2 ] = state.mAxes[ AXIS_L ];
+    dtm[ 3 ] = state.mAxes[ AXIS_R ];
+    dtm[ 4 ] = state.mAxes[ AXIS_STICK_X ];
+    dtm[ 5 ] = state.mAxes[ AXIS_STICK_Y ];
+    dtm[ 6 ] = state.mAxes[ AXIS_C_STICK_X ];
+    dtm[ 7 ] = state.mAxes[ AXIS_C_STICK_Y ];
+}
+
+// writes every status response as an input of a dolphin movie for controller port 1. the header
+// counts are patched in once all frames have been streamed
+void GameCubeControllerAnalyzerResults::ExportDolphinMovie( const char* file )
+{
+    GameCubeControllerExportWriter writer( file, true );
+
+    U8 header[ DTM_HEADER_SIZE ] = { 'D', 'T', 'M', 0x1A };
+    header[ DTM_CONTROLLERS_OFFSET ] = 0x01;
+    writer.Write( header, DTM_HEADER_SIZE );
+
+    U64 burst_gap = static_cast<U64>( mAnalyzer->GetSampleRate() * BURST_GAP_S );
+
+    // axes a poll mode doesn't report keep their last value, starting from neutral
+    GameCubeControllerState held = {};
+    for( U32 i = AXIS_STICK_X; i <= AXIS_C_STICK_Y; i++ )
+    {
+        held.mAxes[ i ] = 128;
+    }
+
+    U64 input_count = 0;
+    U64 frame_count = 0;
+    U64 last_end = 0;
+
+    U64 num_frames = GetNumFrames();
+    for( U64 i = 0; i < num_frames; i++ )
+    {
+        Frame frame = GetFrame( i );
+
+        GameCubeControllerState state;
+        if( ( frame.mType == CMD_STATUS || frame.mType == CMD_STATUS_LONG ) && UnpackFrameState( frame, state ) )
+        {
+            if( input_count == 0 || frame.mStartingSampleInclusive - last_end > burst_gap )
+            {
+                frame_count++;
+            }
+            last_end = frame.mEndingSampleInclusive;
+
+            held.mButtons[ 0 ] = state.mButtons[ 0 ];
+            held.mButtons[ 1 ] = state.mButtons[ 1 ];
+            for( U32 axis = 0; axis < AXIS_COUNT; axis++ )
+            {
+                if( state.mAxesPresent & ( 1 << axis ) )
+                {
+                    held.mAxes[ axis ] = state.mAxes[ axis ];
+                }
+            }
+
+            U8 dtm[ 8 ];
+            PackDolphinState( held, dtm );
+            writer.Write( dtm, sizeof( dtm ) );
+            input_count++;
+        }
+
+        if( UpdateExportProgressAndCheckForCancel( i, num_frames ) == true )
+        {
+            return;
+        }
+    }
+
+    U8 count[ 8 ];
+    for( U32 i = 0; i < 8; i++ )
+    {
+        count[ i ] = static_cast<U8>( frame_count >> ( i * 8 ) );
+    }
+    writer.Patch( DTM_FRAME_COUNT_OFFSET, count, sizeof( count ) );
+
+    for( U32 i = 0; i < 8; i++ )
+    {
+        count[ i ] = static_cast<U8>( input_count >> ( i * 8 ) );
+    }
+    writer.Patch( DTM_INPUT_COUNT_OFFSET, count, sizeof( count ) );
+}
+
+// writes one row per video frame, covering the same bursts as the packet table. in rolling mode that's
+// only the bursts still kept
+void GameCubeControllerAnalyzerResults::ExportBursts( const char* file )
+{
+    GameCubeControllerExportWriter writer( file );
+
+    U64 trigger_sample = mAnalyzer->GetTriggerSample();
+    U32 sample_rate = mAnalyzer->GetSampleRate();
+
+    writer.Write( "Time [s], Session, Polls, State Changes, Min Latency [us], Max Latency [us]\n" );
+
+    U64 first_burst = mBursts.GetFirstBurst();
+    U64 num_bursts = mBursts.GetBurstCount();
+    for( U64 i = first_burst; i < num_bursts; i++ )
+    {
+        // the window may have moved on since the export started
+        GameCubeControllerBurst burst;
+        if( !mBursts.GetBurst( i, burst ) )
+        {
+            continue;
+        }
+
+        char time_str[ 128 ];
+        AnalyzerHelpers::GetTimeString( burst.mStartSample, trigger_sample, sample_rate, time_str, 128 );
+
+        std::string row = time_str;
+        row += "," + std::to_string( burst.mSession ) + "," + std::to_string( burst.mPolls ) + "," + std::to_string( burst.mStateChanges );
+        if( burst.mPolls > 0 )
+        {
+            row += "," + FormatMicroseconds( burst.mMinLatency, sample_rate ) + "," + FormatMicroseconds( burst.mMaxLatency, sample_rate );
+        }
+        else
+        {
+            row += ",,";
+        }
+        row += "\n";
+        writer.Write( row );
+
+        if( UpdateExportProgressAndCheckForCancel( i - first_burst, num_bursts - first_burst ) == true )
+        {
+            return;
+        }
+    }
+
+    writer.Close();
+}
+
+// writes one row per span of the motor in one mode. the mode still running when decoding stopped has no
+// end
+void GameCubeControllerAnalyzerResults::ExportMotorTimeline( const char* file )
+{
+    GameCubeControllerExportWriter writer( file );
+
+    U64 trigger_sample = mAnalyzer->GetTriggerSample();
+    U32 sample_rate = mAnalyzer->GetSampleRate();
+
+    writer.Write( "Start [s], End [s], Duration [s], Mode\n" );
+
+    std::vector<GameCubeControllerMotorSpan> spans;
+    mMotorTimeline.GetSpans( spans );
+    for( size_t i = 0; i < spans.size(); i++ )
+    {
+        const GameCubeControllerMotorSpan& span = spans[ i ];
+
+        char time_str[ 128 ];
+        AnalyzerHelpers::GetTimeString( span.mStartSample, trigger_sample, sample_rate, time_str, 128 );
+        std::string row = time_str;
+        row += ",";
+
+        if( i + 1 < spans.size() )
+        {
+            AnalyzerHelpers::GetTimeString( span.mEndSample, trigger_sample, sample_rate, time_str, 128 );
+            row += time_str;
+            row += ",";
+            AnalyzerHelpers::GetTimeString( span.mEndSample - span.mStartSample, 0, sample_rate, time_str, 128 );
+            row += time_str;
+        }
+        else
+        {
+            row += ",";
+        }
+
+        row += ",";
+        row += JOYBUS_MOTOR_MODE_NAMES[ span.mMode ];
+        row += "\n";
+        writer.Write( row );
+
+        if( UpdateExportProgressAndCheckForCancel( i, spans.size() ) == true )
+        {
+            return;
+        }
+    }
+
+    writer.Close();
+}
+
+// writes every input event in time order by merging the per-input event lists. each event is followed
+// by how long the input stayed that way, found with a binary search for the opposite event
+void GameCubeControllerAnalyzerResults::ExportInputEvents( const char* file )
+{
+    std::ofstream file_stream( file, std::ios::out );
+
+    U64 trigger_sample = mAnalyzer->GetTriggerSample();
+    U32 sample_rate = mAnalyzer->GetSampleRate();
+
+    file_stream << "Time [s], Input, Event, Duration [s]" << std::endl;
+
+    const U32 list_count = GameCubeControllerEventIndex::INPUT_COUNT * 2;
+    std::vector<U64> events[ list_count ];
+    size_t next[ list_count ] = {};
+    U64 num_events = 0;
+    for( U32 i = 0; i < list_count; i++ )
+    {
+        mEventIndex.GetEvents( i / 2, i % 2 == 0, events[ i ] );
+        num_events += events[ i ].size();
+    }
+
+    for( U64 n = 0; n < num_events; n++ )
+    {
+        U32 earliest = list_count;
+        for( U32 i = 0; i < list_count; i++ )
+        {
+            if( next[ i ] < events[ i ].size() && ( earliest == list_count || events[ i ][ next[ i ] ] < events[ earliest ][ next[ earliest ] ] ) )
+            {
+                earliest = i;
+            }
+        }
+
+        U32 input = earliest / 2;
+        bool active = earliest % 2 == 0;
+        const char* event = input < BUTTON_COUNT ? ( active ? "Press" : "Release" ) : ( active ? "Above Threshold" : "Below Threshold" );
+
+        U64 sample = events[ earliest ][ next[ earliest ]++ ];
+        char time_str[ 128 ];
+        AnalyzerHelpers::GetTimeString( sample, trigger_sample, sample_rate, time_str, 128 );
+
+        // left empty if the input never changed back
+        char duration_str[ 32 ] = "";
+        U64 end_sample;
+        if( mEventIndex.FindNext( input, !active, sample, end_sample ) )
+        {
+            snprintf( duration_str, sizeof( duration_str ), "%.6f", ( end_sample - sample ) / double( sample_rate ) );
+        }
+
+        file_stream << time_str << "," << GameCubeControllerEventIndex::GetInputName( input ) << "," << event << "," << duration_str
+                    << std::endl;
+
+        if( UpdateExportProgressAndCheckForCancel( n, num_events ) == true )
+        {
+            file_stream.close();
+            return;
+        }
+    }
+
+    file_stream.close();
+}
@@ -1,7 +1,46 @@
 #ifndef GAMECUBECONTROLLER_ANALYZER_RESULTS
 #define GAMECUBECONTROLLER_ANALYZER_RESULTS
 
+#include "GameCubeControllerAnalytics.h"
+#include "GameCubeControllerBursts.h"
+#include "GameCubeControllerCommands.h"
+#include "GameCubeControllerEventIndex.h"
+#include "GameCubeControllerExportPipeline.h"
+#include "GameCubeControllerMotorTimeline.h"
+
 #include <AnalyzerResults.h>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// frames other than command/response packets are told apart by the low byte of mData2
+enum GameCubeControllerFrameKind
+{
+    FRAME_PACKET = 0,
+    // a run of mData1 polls with the same command and state as the packet frame before it, folded into
+    // one frame in rolling mode
+    FRAME_REPEAT = 1,
+    // the host's half of a packet when commands and responses are split. packed like a packet frame
+    // without a controller state, but with the first eight argument bytes. the packet frame following it
+    // then only covers the response
+    FRAME_COMMAND = 2,
+};
+
+// packet frames keep a compact copy of their decoded contents, so text can be generated from the
+// frame alone:
+//   mData1: buttons[ 0 ], buttons[ 1 ] and the first six axes, one byte each from the low byte up. if
+//           the packet has no controller state, the first eight response bytes instead
+//   mData2: bits 0-7 the frame kind, bit 8 set if the packet has a controller state, bits 16-23 the
+//           present axes or the response length, bits 24-39 the last two axes. the events the packet
+//           caused follow: bits 40-45 one more than the lowest input pattern it matched, or 0. bit 46
+//           set if it changed the rumble motor's mode, bits 47-48 the new mode. bit 49 set if it caused
+//           drift events, bits 50-51 the first one's GameCubeControllerDriftEventType, bits 52-55 its axis.
+//           bit 56 set if it completed the host's fingerprint, bits 57-58 the GameCubeControllerHostType
+void PackFrameContents( const JoyBusPacket& packet, Frame& frame );
+void PackCommandFrameContents( const JoyBusPacket& packet, Frame& frame );
+GameCubeControllerFrameKind GetFrameKind( const Frame& frame );
+bool UnpackFrameState( const Frame& frame, GameCubeControllerState& state );
+U32 UnpackFrameResponse( const Frame& frame, U8* response );
 
 class GameCubeControllerAnalyzer;
 class GameCubeControllerAnalyzerSettings;
@@ -19,10 +58,54 @@ class GameCubeControllerAnalyzerResults : public AnalyzerResults
     virtual void GeneratePacketTabularText( U64 packet_id, DisplayBase display_base );
     virtual void GenerateTransactionTabularText( U64 transaction_id, DisplayBase display_base );
 
+    GameCubeControllerEventIndex& GetEventIndex();
+    GameCubeControllerAnalytics& GetAnalytics();
+    GameCubeControllerBursts& GetBursts();
+    GameCubeControllerMotorTimeline& GetMotorTimeline();
+
+    // the worker thread hands over the text of every input pattern once they are compiled, so bubbles
+    // can name matches without reading the trigger it is evaluating
+    void SetPatternTexts( const std::vector<std::string>& texts );
+
   protected: // functions
+    void ExportFrames( const char* file, DisplayBase display_base );
+    // runs on the export pipeline's worker threads
+    void FormatFrameRows( GameCubeControllerExportPipeline::Chunk& chunk, DisplayBase display_base, U64 trigger_sample, U32 sample_rate );
+    void ExportInputEvents( const char* file );
+    void ExportAnalytics( const char* file, bool binary );
+    void ExportResampledStates( const char* file, DisplayBase display_base, bool binary );
+    void ExportDolphinMovie( const char* file );
+    void ExportBursts( const char* file );
+    void ExportMotorTimeline( const char* file );
+
+    // strings are ordered from shortest to longest. only reads the frame and the settings, so exports
+    // may call this from several threads at once
+    void FormatFrameStrings( const Frame& frame, DisplayBase display_base, std::vector<std::string>& strings );
+    void AppendFrameEvents( const Frame& frame, std::vector<std::string>& strings );
+    const std::vector<std::string>& GetCachedFrameStrings( U64 frame_index, DisplayBase display_base );
+
   protected: // vars
     GameCubeControllerAnalyzerSettings* mSettings;
     GameCubeControllerAnalyzer* mAnalyzer;
+    GameCubeControllerEventIndex mEventIndex;
+    GameCubeControllerAnalytics mAnalytics;
+    GameCubeControllerBursts mBursts;
+    GameCubeControllerMotorTimeline mMotorTimeline;
+
+    std::vector<std::string> mPatternTexts;
+    std::mutex mPatternTextsMutex;
+
+    // bubbles are regenerated on every redraw while panning and zooming. frames never change once
+    // added, so formatted text is kept in a direct-mapped cache indexed by frame
+    struct TextCacheEntry
+    {
+        U64 mFrameIndex;
+        DisplayBase mDisplayBase;
+        std::vector<std::string> mStrings;
+    };
+    static const U32 TEXT_CACHE_SIZE = 4096;
+    std::vector<TextCacheEntry> mTextCache;
+    std::mutex mTextCacheMutex;
 };
 
 #endif // GAMECUBECONTROLLER_ANALYZER_RESULTS
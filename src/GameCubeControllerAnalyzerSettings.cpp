@@ -1,18 +1,156 @@
 #include "GameCubeControllerAnalyzerSettings.h"
 
+#include "GameCubeControllerDrift.h"
+#include "GameCubeControllerTrigger.h"
+
 #include <AnalyzerHelpers.h>
 
-GameCubeControllerAnalyzerSettings::GameCubeControllerAnalyzerSettings() : mInputChannel( UNDEFINED_CHANNEL )
+GameCubeControllerAnalyzerSettings::GameCubeControllerAnalyzerSettings() : mInputChannel( UNDEFINED_CHANNEL ), mDevice( DEVICE_GAMECUBE ),
+      mStickEventThreshold( 64 ),
+      mTriggerEventThreshold( 128 ),
+      mCollectAnalytics( false ),
+      mResampleRateHz( 1000 ),
+      mVideoFrameRateHz( 59.94 ),
+      mResultsWindowS( 0 ),
+      mDriftThreshold( 12 ),
+      mSplitFrames( false ),
+      mNamedButtons( false )
 {
     mInputChannelInterface.reset( new AnalyzerSettingInterfaceChannel() );
     mInputChannelInterface->SetTitleAndTooltip( "Data", "GameCube controller data line" );
     mInputChannelInterface->SetChannel( mInputChannel );
 
+    mDeviceInterface.reset( new AnalyzerSettingInterfaceNumberList() );
+    mDeviceInterface->SetTitleAndTooltip( "Device", "The console family whose commands are decoded" );
+    mDeviceInterface->AddNumber( DEVICE_GAMECUBE, "GameCube", "GameCube controllers, keyboards and GBA link" );
+    mDeviceInterface->AddNumber( DEVICE_N64, "N64", "N64 controllers, controller paks and rumble paks" );
+    mDeviceInterface->SetNumber( mDevice );
+
+    mStickEventThresholdInterface.reset( new AnalyzerSettingInterfaceInteger() );
+    mStickEventThresholdInterface->SetTitleAndTooltip( "Stick Event Threshold",
+                                                       "Deflection from center at which a stick counts as moved in the input event export" );
+    mStickEventThresholdInterface->SetMin( 1 );
+    mStickEventThresholdInterface->SetMax( 127 );
+    mStickEventThresholdInterface->SetInteger( mStickEventThreshold );
+
+    mTriggerEventThresholdInterface.reset( new AnalyzerSettingInterfaceInteger() );
+    mTriggerEventThresholdInterface->SetTitleAndTooltip( "Trigger Event Threshold",
+                                                         "Value at which an analog trigger or button counts as pressed in the input event export" );
+    mTriggerEventThresholdInterface->SetMin( 1 );
+    mTriggerEventThresholdInterface->SetMax( 255 );
+    mTriggerEventThresholdInterface->SetInteger( mTriggerEventThreshold );
+
+    mInputPatternsInterface.reset( new AnalyzerSettingInterfaceText() );
+    mInputPatternsInterface->SetTitleAndTooltip( "Input Patterns",
+                                                 "Marks status responses matching these patterns, separated by ';'. "
+                                                 "e.g. \"L+R+A+Start; SX<64, SX>192 within 100ms\"" );
+    mInputPatternsInterface->SetText( mInputPatterns.c_str() );
+
+    mCollectAnalyticsInterface.reset( new AnalyzerSettingInterfaceBool() );
+    mCollectAnalyticsInterface->SetTitleAndTooltip( "Stick Analytics",
+                                                    "Collects stick heatmaps and axis histograms relative to the controller origin for export" );
+    mCollectAnalyticsInterface->SetCheckBoxText( "Collect stick and trigger analytics" );
+    mCollectAnalyticsInterface->SetValue( mCollectAnalytics );
+
+    mResampleRateInterface.reset( new AnalyzerSettingInterfaceInteger() );
+    mResampleRateInterface->SetTitleAndTooltip( "Resample Rate (Hz)",
+                                                "Rate of the resampled controller state export, e.g. 60 for one state per video frame" );
+    mResampleRateInterface->SetMin( 1 );
+    mResampleRateInterface->SetMax( 1000000 );
+    mResampleRateInterface->SetInteger( mResampleRateHz );
+
+    mVideoFrameRateInterface.reset( new AnalyzerSettingInterfaceNumberList() );
+    mVideoFrameRateInterface->SetTitleAndTooltip( "Video Frame Rate", "Polls are grouped into one packet per video frame of the console" );
+    mVideoFrameRateInterface->AddNumber( 59.94, "NTSC (59.94 Hz)", "NTSC consoles and PAL consoles in 60 Hz mode" );
+    mVideoFrameRateInterface->AddNumber( 50.0, "PAL (50 Hz)", "PAL consoles in 50 Hz mode" );
+    mVideoFrameRateInterface->SetNumber( mVideoFrameRateHz );
+
+    mResultsWindowInterface.reset( new AnalyzerSettingInterfaceInteger() );
+    mResultsWindowInterface->SetTitleAndTooltip( "Results Window (s)",
+                                                 "0 keeps everything. Otherwise bit markers are left out, identical polls within a video "
+                                                 "frame are folded into one frame, and only this many seconds of video frame summaries and "
+                                                 "input events are kept, for monitoring over many hours" );
+    mResultsWindowInterface->SetMin( 0 );
+    mResultsWindowInterface->SetMax( 86400 );
+    mResultsWindowInterface->SetInteger( mResultsWindowS );
+
+    mDriftThresholdInterface.reset( new AnalyzerSettingInterfaceInteger() );
+    mDriftThresholdInterface->SetTitleAndTooltip( "Drift Threshold",
+                                                  "Distance from the reported origin at which a stick or trigger left at rest is "
+                                                  "marked as drifting. Axes held further out are taken as deliberate input" );
+    mDriftThresholdInterface->SetMin( 1 );
+    mDriftThresholdInterface->SetMax( GameCubeControllerDriftDetector::MAX_OFFSET );
+    mDriftThresholdInterface->SetInteger( mDriftThreshold );
+
+    mSplitFramesInterface.reset( new AnalyzerSettingInterfaceBool() );
+    mSplitFramesInterface->SetTitleAndTooltip( "Split Frames",
+                                               "Shows the host's command and the controller's response as separate frames, with the "
+                                               "turnaround between them" );
+    mSplitFramesInterface->SetCheckBoxText( "Separate command and response frames" );
+    mSplitFramesInterface->SetValue( mSplitFrames );
+
+    mSimulationCaptureInterface.reset( new AnalyzerSettingInterfaceText() );
+    mSimulationCaptureInterface->SetTitleAndTooltip( "Simulation Capture",
+                                                     "Replays a capture archive, vcd or sigrok session as the simulated data instead of "
+                                                     "the built-in traffic. Edges are exact if the simulation runs at the capture's "
+                                                     "sample rate" );
+    mSimulationCaptureInterface->SetTextType( AnalyzerSettingInterfaceText::FilePath );
+    mSimulationCaptureInterface->SetText( mSimulationCapture.c_str() );
+
+    mFrameFieldsInterface.reset( new AnalyzerSettingInterfaceText() );
+    mFrameFieldsInterface->SetTitleAndTooltip( "Status Fields",
+                                               "Controller state fields added to frames, separated by ','. Empty adds all of Poll Mode, "
+                                               "Motor Mode, Buttons, Joystick X/Y, C-Stick X/Y, L/R/A/B Analog, State and Offsets" );
+    mFrameFieldsInterface->SetText( mFrameFields.c_str() );
+
+    mNamedButtonsInterface.reset( new AnalyzerSettingInterfaceBool() );
+    mNamedButtonsInterface->SetTitleAndTooltip( "Named Buttons",
+                                                "Adds the pressed buttons by name, e.g. \"A+Start\", instead of as a raw value" );
+    mNamedButtonsInterface->SetCheckBoxText( "Name pressed buttons" );
+    mNamedButtonsInterface->SetValue( mNamedButtons );
+
     AddInterface( mInputChannelInterface.get() );
+    AddInterface( mDeviceInterface.get() );
+    AddInterface( mStickEventThresholdInterface.get() );
+    AddInterface( mTriggerEventThresholdInterface.get() );
+    AddInterface( mInputPatternsInterface.get() );
+    AddInterface( mCollectAnalyticsInterface.get() );
+    AddInterface( mResampleRateInterface.get() );
+    AddInterface( mVideoFrameRateInterface.get() );
+    AddInterface( mResultsWindowInterface.get() );
+    AddInterface( mDriftThresholdInterface.get() );
+    AddInterface( mSplitFramesInterface.get() );
+    AddInterface( mSimulationCaptureInterface.get() );
+    AddInterface( mFrameFieldsInterface.get() );
+    AddInterface( mNamedButtonsInterface.get() );
 
-    AddExportOption( 0, "Export as text/csv file" );
-    AddExportExtension( 0, "text", "txt" );
-    AddExportExtension( 0, "csv", "csv" );
+    AddExportOption( EXPORT_FRAMES, "Export as text/csv file" );
+    AddExportExtension( EXPORT_FRAMES, "text", "txt" );
+    AddExportExtension( EXPORT_FRAMES, "csv", "csv" );
+
+    AddExportOption( EXPORT_INPUT_EVENTS, "Export input events as csv file" );
+    AddExportExtension( EXPORT_INPUT_EVENTS, "csv", "csv" );
+
+    AddExportOption( EXPORT_ANALYTICS, "Export stick analytics as csv file" );
+    AddExportExtension( EXPORT_ANALYTICS, "csv", "csv" );
+
+    AddExportOption( EXPORT_ANALYTICS_BINARY, "Export stick analytics as binary file" );
+    AddExportExtension( EXPORT_ANALYTICS_BINARY, "binary", "bin" );
+
+    AddExportOption( EXPORT_RESAMPLED, "Export resampled controller state as csv file" );
+    AddExportExtension( EXPORT_RESAMPLED, "csv", "csv" );
+
+    AddExportOption( EXPORT_RESAMPLED_BINARY, "Export resampled controller state as binary file" );
+    AddExportExtension( EXPORT_RESAMPLED_BINARY, "binary", "bin" );
+
+    AddExportOption( EXPORT_DOLPHIN_MOVIE, "Export status responses as Dolphin movie" );
+    AddExportExtension( EXPORT_DOLPHIN_MOVIE, "Dolphin movie", "dtm" );
+
+    AddExportOption( EXPORT_BURSTS, "Export video frame summaries as csv file" );
+    AddExportExtension( EXPORT_BURSTS, "csv", "csv" );
+
+    AddExportOption( EXPORT_MOTOR, "Export rumble motor timeline as csv file" );
+    AddExportExtension( EXPORT_MOTOR, "csv", "csv" );
 
     ClearChannels();
     AddChannel( mInputChannel, "Serial", false );
@@ -24,7 +162,35 @@ GameCubeControllerAnalyzerSettings::~GameCubeControllerAnalyzerSettings()
 
 bool GameCubeControllerAnalyzerSettings::SetSettingsFromInterfaces()
 {
+    std::string error;
+    GameCubeControllerTrigger trigger;
+    if( !trigger.Compile( mInputPatternsInterface->GetText(), error ) )
+    {
+        SetErrorText( error.c_str() );
+        return false;
+    }
+
+    U32 fields;
+    if( !ParseFrameFields( mFrameFieldsInterface->GetText(), fields, error ) )
+    {
+        SetErrorText( error.c_str() );
+        return false;
+    }
+
     mInputChannel = mInputChannelInterface->GetChannel();
+    mDevice = static_cast<JoyBusDevice>( static_cast<U32>( mDeviceInterface->GetNumber() ) );
+    mStickEventThreshold = mStickEventThresholdInterface->GetInteger();
+    mTriggerEventThreshold = mTriggerEventThresholdInterface->GetInteger();
+    mInputPatterns = mInputPatternsInterface->GetText();
+    mCollectAnalytics = mCollectAnalyticsInterface->GetValue();
+    mResampleRateHz = mResampleRateInterface->GetInteger();
+    mVideoFrameRateHz = mVideoFrameRateInterface->GetNumber();
+    mResultsWindowS = mResultsWindowInterface->GetInteger();
+    mDriftThreshold = mDriftThresholdInterface->GetInteger();
+    mSplitFrames = mSplitFramesInterface->GetValue();
+    mSimulationCapture = mSimulationCaptureInterface->GetText();
+    mFrameFields = mFrameFieldsInterface->GetText();
+    mNamedButtons = mNamedButtonsInterface->GetValue();
 
     ClearChannels();
     AddChannel( mInputChannel, "GameCube", true );
@@ -35,6 +201,19 @@ bool GameCubeControllerAnalyzerSettings::SetSettingsFromInterfaces()
 void GameCubeControllerAnalyzerSettings::UpdateInterfacesFromSettings()
 {
     mInputChannelInterface->SetChannel( mInputChannel );
+    mDeviceInterface->SetNumber( mDevice );
+    mStickEventThresholdInterface->SetInteger( mStickEventThreshold );
+    mTriggerEventThresholdInterface->SetInteger( mTriggerEventThreshold );
+    mInputPatternsInterface->SetText( mInputPatterns.c_str() );
+    mCollectAnalyticsInterface->SetValue( mCollectAnalytics );
+    mResampleRateInterface->SetInteger( mResampleRateHz );
+    mVideoFrameRateInterface->SetNumber( mVideoFrameRateHz );
+    mResultsWindowInterface->SetInteger( mResultsWindowS );
+    mDriftThresholdInterface->SetInteger( mDriftThreshold );
+    mSplitFramesInterface->SetValue( mSplitFrames );
+    mSimulationCaptureInterface->SetText( mSimulationCapture.c_str() );
+    mFrameFieldsInterface->SetText( mFrameFields.c_str() );
+    mNamedButtonsInterface->SetValue( mNamedButtons );
 }
 
 void GameCubeControllerAnalyzerSettings::LoadSettings( const char* settings )
@@ -44,6 +223,37 @@ void GameCubeControllerAnalyzerSettings::LoadSettings( const char* settings )
 
     text_archive >> mInputChannel;
 
+    // settings saved before the device option existed decode as a GameCube
+    U32 device;
+    mDevice = ( text_archive >> device ) ? static_cast<JoyBusDevice>( device ) : DEVICE_GAMECUBE;
+    text_archive >> mStickEventThreshold;
+    text_archive >> mTriggerEventThreshold;
+
+    const char* input_patterns;
+    if( text_archive >> &input_patterns )
+    {
+        mInputPatterns = input_patterns;
+    }
+    text_archive >> mCollectAnalytics;
+    text_archive >> mResampleRateHz;
+    text_archive >> mVideoFrameRateHz;
+    text_archive >> mResultsWindowS;
+    text_archive >> mDriftThreshold;
+    text_archive >> mSplitFrames;
+
+    const char* simulation_capture;
+    if( text_archive >> &simulation_capture )
+    {
+        mSimulationCapture = simulation_capture;
+    }
+
+    const char* frame_fields;
+    if( text_archive >> &frame_fields )
+    {
+        mFrameFields = frame_fields;
+    }
+    text_archive >> mNamedButtons;
+
     ClearChannels();
     AddChannel( mInputChannel, "GameCube", true );
 
@@ -55,6 +265,19 @@ const char* GameCubeControllerAnalyzerSettings::SaveSettings()
     SimpleArchive text_archive;
 
     text_archive << mInputChannel;
+    text_archive << static_cast<U32>( mDevice );
+    text_archive << mStickEventThreshold;
+    text_archive << mTriggerEventThreshold;
+    text_archive << mInputPatterns.c_str();
+    text_archive << mCollectAnalytics;
+    text_archive << mResampleRateHz;
+    text_archive << mVideoFrameRateHz;
+    text_archive << mResultsWindowS;
+    text_archive << mDriftThreshold;
+    text_archive << mSplitFrames;
+    text_archive << mSimulationCapture.c_str();
+    text_archive << mFrameFields.c_str();
+    text_archive << mNamedButtons;
 
     return SetReturnString( text_archive.GetString() );
 }
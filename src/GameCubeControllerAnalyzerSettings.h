@@ -1,8 +1,11 @@
 #ifndef GAMECUBECONTROLLER_ANALYZER_SETTINGS
 #define GAMECUBECONTROLLER_ANALYZER_SETTINGS
 
+#include "GameCubeControllerCommands.h"
+
 #include <AnalyzerSettings.h>
 #include <AnalyzerTypes.h>
+#include <string>
 
 class GameCubeControllerAnalyzerSettings : public AnalyzerSettings
 {
@@ -15,11 +18,50 @@ class GameCubeControllerAnalyzerSettings : public AnalyzerSettings
     virtual void LoadSettings( const char* settings );
     virtual const char* SaveSettings();
 
+    enum ExportType
+    {
+        EXPORT_FRAMES = 0,
+        EXPORT_INPUT_EVENTS = 1,
+        EXPORT_ANALYTICS = 2,
+        EXPORT_ANALYTICS_BINARY = 3,
+        EXPORT_RESAMPLED = 4,
+        EXPORT_RESAMPLED_BINARY = 5,
+        EXPORT_DOLPHIN_MOVIE = 6,
+        EXPORT_BURSTS = 7,
+        EXPORT_MOTOR = 8,
+    };
+
     Channel mInputChannel;
     U32 mBitRate;
+    JoyBusDevice mDevice;
+    U32 mStickEventThreshold;
+    U32 mTriggerEventThreshold;
+    std::string mInputPatterns;
+    bool mCollectAnalytics;
+    U32 mResampleRateHz;
+    double mVideoFrameRateHz;
+    U32 mResultsWindowS;
+    U32 mDriftThreshold;
+    bool mSplitFrames;
+    std::string mSimulationCapture;
+    std::string mFrameFields;
+    bool mNamedButtons;
 
   protected:
     std::auto_ptr<AnalyzerSettingInterfaceChannel> mInputChannelInterface;
+    std::auto_ptr<AnalyzerSettingInterfaceNumberList> mDeviceInterface;
+    std::auto_ptr<AnalyzerSettingInterfaceInteger> mStickEventThresholdInterface;
+    std::auto_ptr<AnalyzerSettingInterfaceInteger> mTriggerEventThresholdInterface;
+    std::auto_ptr<AnalyzerSettingInterfaceText> mInputPatternsInterface;
+    std::auto_ptr<AnalyzerSettingInterfaceBool> mCollectAnalyticsInterface;
+    std::auto_ptr<AnalyzerSettingInterfaceInteger> mResampleRateInterface;
+    std::auto_ptr<AnalyzerSettingInterfaceNumberList> mVideoFrameRateInterface;
+    std::auto_ptr<AnalyzerSettingInterfaceInteger> mResultsWindowInterface;
+    std::auto_ptr<AnalyzerSettingInterfaceInteger> mDriftThresholdInterface;
+    std::auto_ptr<AnalyzerSettingInterfaceBool> mSplitFramesInterface;
+    std::auto_ptr<AnalyzerSettingInterfaceText> mSimulationCaptureInterface;
+    std::auto_ptr<AnalyzerSettingInterfaceText> mFrameFieldsInterface;
+    std::auto_ptr<AnalyzerSettingInterfaceBool> mNamedButtonsInterface;
 };
 
 #endif // GAMECUBECONTROLLER_ANALYZER_SETTINGS
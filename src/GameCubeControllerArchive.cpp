@@ -0,0 +1,632 @@
+#include "GameCubeControllerArchive.h"
+
+#include "GameCubeControllerExportWriter.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+// layout, all little endian:
+//   "JBAR", version (4 bytes), sample rate (4 bytes), initial level (1 byte), edge count (8 bytes)
+//   records packed into a bit stream, least significant bit first, each starting with its type (2 bits)
+//   and the distance of its first edge from the last edge before it (a number):
+//     packet: pulse count (a number), then per pulse its bit value (1 bit), the residual of its low time
+//             and, except for the last pulse, the residual of the high time after it
+//     raw:    edge count - 1 (a number), then the distance of every further edge from the one before it
+//     end:    nothing
+// a number is its bit length (7 bits) followed by that many bits. a residual is the difference from the
+// prediction, zigzag encoded and rice coded with a parameter adapted per context
+static const U8 ARCHIVE_MAGIC[ 4 ] = { 'J', 'B', 'A', 'R' };
+static const U32 ARCHIVE_VERSION = 1;
+static const U32 ARCHIVE_HEADER_SIZE = 21;
+static const U32 ARCHIVE_EDGE_COUNT_OFFSET = 13;
+
+// edges are handed to the decoder in chunks of this many
+static const size_t ARCHIVE_EDGE_CHUNK = 1 << 16;
+// longer runs of pulses are split over several records, which bounds the edges held back by the writer
+static const U64 MAX_RECORD_PULSES = 1 << 16;
+// residuals whose rice code would have a longer unary part are escaped and stored as a number
+static const U32 RICE_ESCAPE = 24;
+
+namespace
+{
+    enum RecordType
+    {
+        RECORD_END = 0,
+        RECORD_PACKET = 1,
+        RECORD_RAW = 2,
+    };
+    const U32 RECORD_TYPE_BITS = 2;
+
+    // residual contexts: the low time of a 0 or a 1, then the high time after a 0 or a 1
+    const U32 CONTEXT_LOW = 0;
+    const U32 CONTEXT_HIGH = 2;
+    const U32 CONTEXT_COUNT = 4;
+
+    // what both sides predict from. the writer only makes decisions the reader can rebuild from what was
+    // already read
+    struct Model
+    {
+        void Reset()
+        {
+            for( U32 i = 0; i < 2; i++ )
+            {
+                mLow[ i ] = mHigh[ i ] = 0;
+            }
+            for( U32 i = 0; i < CONTEXT_COUNT; i++ )
+            {
+                mSum[ i ] = mCount[ i ] = 1;
+            }
+        }
+
+        // the smallest parameter whose codes are at most a bit longer than the mean residual
+        U32 GetRiceParameter( U32 context ) const
+        {
+            U32 k = 0;
+            while( k < 60 && ( mCount[ context ] << k ) < mSum[ context ] )
+            {
+                k++;
+            }
+            return k;
+        }
+
+        // halving keeps the statistics following the recent past
+        void Update( U32 context, U64 magnitude )
+        {
+            mSum[ context ] += magnitude;
+            if( ++mCount[ context ] >= 64 )
+            {
+                mSum[ context ] /= 2;
+                mCount[ context ] /= 2;
+            }
+        }
+
+        // the low and high times of the last data bit of each value. the turnaround and the gaps after
+        // a packet don't update the high times, they would only throw off the next prediction
+        U64 mLow[ 2 ];
+        U64 mHigh[ 2 ];
+        U64 mSum[ CONTEXT_COUNT ];
+        U64 mCount[ CONTEXT_COUNT ];
+    };
+
+    U64 ZigZag( S64 value )
+    {
+        return ( static_cast<U64>( value ) << 1 ) ^ static_cast<U64>( value >> 63 );
+    }
+
+    S64 UnZigZag( U64 value )
+    {
+        return static_cast<S64>( value >> 1 ) ^ -static_cast<S64>( value & 1 );
+    }
+
+    U32 BitLength( U64 value )
+    {
+        U32 length = 0;
+        for( ; value != 0; value >>= 1 )
+        {
+            length++;
+        }
+        return length;
+    }
+
+    class BitWriter
+    {
+      public:
+        explicit BitWriter( GameCubeControllerExportWriter& writer ) : mWriter( writer ), mBits( 0 ), mCount( 0 ), mBytes( 0 )
+        {
+        }
+
+        void Write( U64 value, U32 count )
+        {
+            while( count > 0 )
+            {
+                U32 part = std::min( count, 32u );
+                mBits |= ( value & ( ( 1ull << part ) - 1 ) ) << mCount;
+                mCount += part;
+                value >>= part;
+                count -= part;
+
+                while( mCount >= 8 )
+                {
+                    U8 byte = static_cast<U8>( mBits );
+                    mWriter.Write( &byte, 1 );
+                    mBytes++;
+                    mBits >>= 8;
+                    mCount -= 8;
+                }
+            }
+        }
+
+        void WriteNumber( U64 value )
+        {
+            U32 length = BitLength( value );
+            Write( length, 7 );
+            Write( value, length );
+        }
+
+        void WriteResidual( Model& model, U32 context, S64 residual )
+        {
+            U64 value = ZigZag( residual );
+            U32 k = model.GetRiceParameter( context );
+            U64 quotient = value >> k;
+            if( quotient < RICE_ESCAPE )
+            {
+                Write( ( 1ull << quotient ) - 1, static_cast<U32>( quotient ) + 1 );
+                Write( value, k );
+            }
+            else
+            {
+                Write( ( 1ull << RICE_ESCAPE ) - 1, RICE_ESCAPE );
+                WriteNumber( value );
+            }
+            model.Update( context, value );
+        }
+
+        // pads the last byte with zeros, which read back as an end record
+        void Flush()
+        {
+            if( mCount > 0 )
+            {
+                Write( 0, 8 - mCount );
+            }
+        }
+
+        U64 GetBytes() const
+        {
+            return mBytes;
+        }
+
+      protected:
+        GameCubeControllerExportWriter& mWriter;
+        U64 mBits;
+        U32 mCount;
+        U64 mBytes;
+    };
+
+    class BitReader
+    {
+      public:
+        void Reset( const U8* data, U64 size )
+        {
+            mData = data;
+            mSize = size;
+            mPosition = 0;
+            mBits = 0;
+            mCount = 0;
+            mOverrun = false;
+        }
+
+        U64 Read( U32 count )
+        {
+            U64 value = 0;
+            for( U32 done = 0; done < count; )
+            {
+                U32 part = std::min( count - done, 32u );
+                while( mCount < part )
+                {
+                    if( mPosition >= mSize )
+                    {
+                        mOverrun = true;
+                        return 0;
+                    }
+                    mBits |= static_cast<U64>( mData[ mPosition++ ] ) << mCount;
+                    mCount += 8;
+                }
+
+                value |= ( mBits & ( ( 1ull << part ) - 1 ) ) << done;
+                mBits >>= part;
+                mCount -= part;
+                done += part;
+            }
+            return value;
+        }
+
+        U64 ReadNumber()
+        {
+            U32 length = static_cast<U32>( Read( 7 ) );
+            if( length > 64 )
+            {
+                mOverrun = true;
+                return 0;
+            }
+            return Read( length );
+        }
+
+        S64 ReadResidual( Model& model, U32 context )
+        {
+            U32 k = model.GetRiceParameter( context );
+            U64 quotient = 0;
+            while( quotient < RICE_ESCAPE && Read( 1 ) != 0 )
+            {
+                quotient++;
+            }
+
+            U64 value = quotient < RICE_ESCAPE ? ( quotient << k ) | Read( k ) : ReadNumber();
+            model.Update( context, value );
+            return UnZigZag( value );
+        }
+
+        bool IsOverrun() const
+        {
+            return mOverrun;
+        }
+
+      protected:
+        const U8* mData;
+        U64 mSize;
+        U64 mPosition;
+        U64 mBits;
+        U32 mCount;
+        bool mOverrun;
+    };
+
+    // splits edges into records. edges are appended as they are read and consumed as records complete
+    class ArchiveEncoder
+    {
+      public:
+        ArchiveEncoder( BitWriter& bits, U32 sample_rate_hz, BitState initial_bit_state, GameCubeControllerArchiveStats& stats )
+            : mBits( bits ),
+              mOneLowSamples( sample_rate_hz * 2ull / 1000000 ),
+              mMaxLowSamples( sample_rate_hz * 5ull / 1000000 ),
+              mMaxHighSamples( sample_rate_hz / 10000ull ),
+              mBitState( initial_bit_state ),
+              mLastEdge( 0 ),
+              mStats( stats )
+        {
+            mModel.Reset();
+        }
+
+        // writes every record that is complete, or everything with final
+        void Encode( bool final )
+        {
+            size_t i = 0;
+            while( i < mEdges.size() )
+            {
+                bool complete = true;
+                U64 pulses = mBitState == BIT_HIGH ? CountPulses( i, final, complete ) : 0;
+                if( !complete )
+                {
+                    break;
+                }
+
+                if( pulses > 0 )
+                {
+                    WritePacket( i, pulses );
+                    i += pulses * 2;
+                    continue;
+                }
+
+                // everything up to the next packet, or as far as the edges go
+                size_t end = i;
+                do
+                {
+                    mBitState = mBitState == BIT_HIGH ? BIT_LOW : BIT_HIGH;
+                    end++;
+                } while( end < mEdges.size() && !( mBitState == BIT_HIGH && ( CountPulses( end, final, complete ) > 0 || !complete ) ) );
+
+                WriteRaw( i, end );
+                i = end;
+            }
+
+            mEdges.erase( mEdges.begin(), mEdges.begin() + i );
+        }
+
+        void Finish()
+        {
+            Encode( true );
+            mBits.Write( RECORD_END, RECORD_TYPE_BITS );
+            mBits.Flush();
+        }
+
+        std::vector<U64> mEdges;
+
+      protected:
+        // the pulses of the packet starting at edge i. a pulse is a low time short enough for a bit, and
+        // the packet goes on while the line doesn't idle in between. complete is false if more edges are
+        // needed to tell
+        U64 CountPulses( size_t i, bool final, bool& complete )
+        {
+            U64 pulses = 0;
+            complete = true;
+            for( size_t j = i; pulses < MAX_RECORD_PULSES; j += 2 )
+            {
+                if( j + 1 >= mEdges.size() )
+                {
+                    complete = final;
+                    break;
+                }
+                if( mEdges[ j + 1 ] - mEdges[ j ] >= mMaxLowSamples )
+                {
+                    break;
+                }
+                pulses++;
+
+                if( j + 2 >= mEdges.size() )
+                {
+                    complete = final;
+                    break;
+                }
+                if( mEdges[ j + 2 ] - mEdges[ j + 1 ] >= mMaxHighSamples )
+                {
+                    break;
+                }
+            }
+            return pulses;
+        }
+
+        void WritePacket( size_t i, U64 pulses )
+        {
+            mBits.Write( RECORD_PACKET, RECORD_TYPE_BITS );
+            mBits.WriteNumber( mEdges[ i ] - mLastEdge );
+            mBits.WriteNumber( pulses );
+
+            for( U64 p = 0; p < pulses; p++ )
+            {
+                U64 fall = mEdges[ i + p * 2 ];
+                U64 rise = mEdges[ i + p * 2 + 1 ];
+
+                U64 low = rise - fall;
+                U32 bit = low < mOneLowSamples;
+                mBits.Write( bit, 1 );
+                mBits.WriteResidual( mModel, CONTEXT_LOW + bit, static_cast<S64>( low - mModel.mLow[ bit ] ) );
+                mModel.mLow[ bit ] = low;
+
+                if( p + 1 < pulses )
+                {
+                    U64 high = mEdges[ i + p * 2 + 2 ] - rise;
+                    mBits.WriteResidual( mModel, CONTEXT_HIGH + bit, static_cast<S64>( high - mModel.mHigh[ bit ] ) );
+                    if( high < mMaxLowSamples )
+                    {
+                        mModel.mHigh[ bit ] = high;
+                    }
+                }
+            }
+
+            mLastEdge = mEdges[ i + pulses * 2 - 1 ];
+            mStats.mEdges += pulses * 2;
+            mStats.mPackets++;
+            mStats.mPacketBits += pulses;
+        }
+
+        void WriteRaw( size_t begin, size_t end )
+        {
+            mBits.Write( RECORD_RAW, RECORD_TYPE_BITS );
+            mBits.WriteNumber( mEdges[ begin ] - mLastEdge );
+            mBits.WriteNumber( end - begin - 1 );
+            for( size_t i = begin + 1; i < end; i++ )
+            {
+                mBits.WriteNumber( mEdges[ i ] - mEdges[ i - 1 ] );
+            }
+
+            mLastEdge = mEdges[ end - 1 ];
+            mStats.mEdges += end - begin;
+            mStats.mRawEdges += end - begin;
+        }
+
+        BitWriter& mBits;
+        Model mModel;
+        U64 mOneLowSamples;
+        U64 mMaxLowSamples;
+        U64 mMaxHighSamples;
+
+        // the level before mEdges[ 0 ], and the last edge written
+        BitState mBitState;
+        U64 mLastEdge;
+
+        GameCubeControllerArchiveStats& mStats;
+    };
+
+    class ArchiveCapture : public GameCubeControllerCapture
+    {
+      public:
+        bool Open( const GameCubeControllerCaptureOptions& options, std::string& error )
+        {
+            if( !mFile.Open( options.mPath.c_str(), error ) )
+            {
+                return false;
+            }
+
+            const U8* data = mFile.GetData();
+            if( mFile.GetSize() < ARCHIVE_HEADER_SIZE || memcmp( data, ARCHIVE_MAGIC, sizeof( ARCHIVE_MAGIC ) ) != 0 )
+            {
+                error = "Not a capture archive";
+                return false;
+            }
+            if( ReadLittleEndian( data + 4, 4 ) != ARCHIVE_VERSION )
+            {
+                error = "Unsupported capture archive version";
+                return false;
+            }
+
+            mSampleRateHz = static_cast<U32>( ReadLittleEndian( data + 8, 4 ) );
+            mStartBitState = data[ 12 ] ? BIT_HIGH : BIT_LOW;
+            mEdgeCount = ReadLittleEndian( data + ARCHIVE_EDGE_COUNT_OFFSET, 8 );
+            if( mSampleRateHz == 0 )
+            {
+                error = "Capture archive has no sample rate";
+                return false;
+            }
+
+            Rewind();
+            return true;
+        }
+
+      protected:
+        virtual bool ReadChunk( std::vector<U64>& edges )
+        {
+            edges.clear();
+            while( !mDone && edges.size() < ARCHIVE_EDGE_CHUNK )
+            {
+                ReadRecord( edges );
+            }
+            return !edges.empty();
+        }
+
+        // records can only be read in order. the reader is already past every edge it handed out, so it
+        // only has to start over for an earlier sample. like the other readers, the level is only taken
+        // where reading restarts, as Seek counts the edges passed from there over several chunks
+        virtual void SeekBefore( U64 sample )
+        {
+            if( sample < mLastEdge )
+            {
+                Rewind();
+            }
+            mInitialBitState = mBitState;
+        }
+
+        void Rewind()
+        {
+            mBits.Reset( mFile.GetData() + ARCHIVE_HEADER_SIZE, mFile.GetSize() - ARCHIVE_HEADER_SIZE );
+            mModel.Reset();
+            mBitState = mStartBitState;
+            mInitialBitState = mStartBitState;
+            mLastEdge = 0;
+            mEdgesRead = 0;
+            mDone = false;
+        }
+
+        // a damaged archive ends at the first record that doesn't fit, rather than producing garbage
+        void ReadRecord( std::vector<U64>& edges )
+        {
+            U64 type = mBits.Read( RECORD_TYPE_BITS );
+            U64 sample = mLastEdge + mBits.ReadNumber();
+
+            if( type == RECORD_PACKET )
+            {
+                U64 pulses = mBits.ReadNumber();
+                if( pulses == 0 || pulses > MAX_RECORD_PULSES || pulses * 2 > mEdgeCount - mEdgesRead )
+                {
+                    mDone = true;
+                    return;
+                }
+
+                for( U64 p = 0; p < pulses; p++ )
+                {
+                    U32 bit = static_cast<U32>( mBits.Read( 1 ) );
+                    U64 low = mModel.mLow[ bit ] + mBits.ReadResidual( mModel, CONTEXT_LOW + bit );
+                    mModel.mLow[ bit ] = low;
+                    edges.push_back( sample );
+                    edges.push_back( sample + low );
+                    sample += low;
+
+                    if( p + 1 < pulses )
+                    {
+                        U64 high = mModel.mHigh[ bit ] + mBits.ReadResidual( mModel, CONTEXT_HIGH + bit );
+                        if( high < mSampleRateHz * 5ull / 1000000 )
+                        {
+                            mModel.mHigh[ bit ] = high;
+                        }
+                        sample += high;
+                    }
+                }
+
+                mEdgesRead += pulses * 2;
+            }
+            else if( type == RECORD_RAW )
+            {
+                U64 count = mBits.ReadNumber() + 1;
+                if( count == 0 || count > mEdgeCount - mEdgesRead )
+                {
+                    mDone = true;
+                    return;
+                }
+
+                edges.push_back( sample );
+                for( U64 i = 1; i < count; i++ )
+                {
+                    sample += mBits.ReadNumber();
+                    edges.push_back( sample );
+                }
+
+                mEdgesRead += count;
+                if( count % 2 == 1 )
+                {
+                    mBitState = mBitState == BIT_HIGH ? BIT_LOW : BIT_HIGH;
+                }
+            }
+            else
+            {
+                mDone = true;
+                return;
+            }
+
+            mLastEdge = edges.back();
+            mDone = mBits.IsOverrun() || mEdgesRead == mEdgeCount;
+        }
+
+        static U64 ReadLittleEndian( const U8* data, U32 size )
+        {
+            U64 value = 0;
+            for( U32 i = 0; i < size; i++ )
+            {
+                value |= static_cast<U64>( data[ i ] ) << ( i * 8 );
+            }
+            return value;
+        }
+
+        BitState mStartBitState;
+        U64 mEdgeCount;
+
+        BitReader mBits;
+        Model mModel;
+        // the level after the last edge read
+        BitState mBitState;
+        U64 mLastEdge;
+        U64 mEdgesRead;
+        bool mDone;
+    };
+}
+
+bool WriteCaptureArchive( GameCubeControllerCapture& capture, const char* path, std::string& error, GameCubeControllerArchiveStats* stats )
+{
+    GameCubeControllerExportWriter writer( path, true );
+    if( !writer.IsOpen() )
+    {
+        error = std::string( "Can't write " ) + path;
+        return false;
+    }
+
+    GameCubeControllerArchiveStats totals;
+    memset( &totals, 0, sizeof( totals ) );
+
+    // the initial level is only known once the first chunk is read
+    std::vector<U64> edges;
+    bool more = capture.ReadEdges( edges );
+
+    writer.Write( ARCHIVE_MAGIC, sizeof( ARCHIVE_MAGIC ) );
+    writer.WriteLittleEndian( ARCHIVE_VERSION, 4 );
+    writer.WriteLittleEndian( capture.GetSampleRate(), 4 );
+    writer.WriteLittleEndian( capture.GetInitialBitState() == BIT_HIGH, 1 );
+    writer.WriteLittleEndian( 0, 8 );
+
+    BitWriter bits( writer );
+    ArchiveEncoder encoder( bits, capture.GetSampleRate(), capture.GetInitialBitState(), totals );
+    while( more )
+    {
+        encoder.mEdges.insert( encoder.mEdges.end(), edges.begin(), edges.end() );
+        encoder.Encode( false );
+        more = capture.ReadEdges( edges );
+    }
+    encoder.Finish();
+
+    writer.Patch( ARCHIVE_EDGE_COUNT_OFFSET, &totals.mEdges, 8 );
+    writer.Close();
+
+    totals.mBytes = ARCHIVE_HEADER_SIZE + bits.GetBytes();
+    if( stats != nullptr )
+    {
+        *stats = totals;
+    }
+    return true;
+}
+
+GameCubeControllerCapture* OpenCaptureArchive( const GameCubeControllerCaptureOptions& options, std::string& error )
+{
+    ArchiveCapture* archive = new ArchiveCapture();
+    if( !archive->Open( options, error ) )
+    {
+        delete archive;
+        return nullptr;
+    }
+    return archive;
+}
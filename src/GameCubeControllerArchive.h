@@ -0,0 +1,34 @@
+#ifndef GAMECUBECONTROLLER_ARCHIVE
+#define GAMECUBECONTROLLER_ARCHIVE
+
+#include "GameCubeControllerCapture.h"
+
+#include <LogicPublicTypes.h>
+#include <string>
+
+// a lossless, compact form of a capture for long-term storage. the edges are modelled as joybus
+// packets: every bit keeps its value and how far its low and high times differ from the last bit with
+// the same value, which is a sample or two of jitter at most and costs a few bits once entropy coded.
+// edges which don't form packets, such as long low pulses or a line starting low, are stored verbatim.
+// reading an archive back gives exactly the edges it was written from, so it decodes exactly like the
+// original capture. archives are opened like any other capture, by the .jba extension or
+// CAPTURE_ARCHIVE
+
+struct GameCubeControllerArchiveStats
+{
+    U64 mEdges;
+    U64 mPackets;
+    U64 mPacketBits;
+    // edges stored verbatim
+    U64 mRawEdges;
+    U64 mBytes;
+};
+
+// reads the whole capture and writes it to path. returns false and sets error if path can't be written
+bool WriteCaptureArchive( GameCubeControllerCapture& capture, const char* path, std::string& error,
+                          GameCubeControllerArchiveStats* stats = nullptr );
+
+// used by GameCubeControllerCapture::Open
+GameCubeControllerCapture* OpenCaptureArchive( const GameCubeControllerCaptureOptions& options, std::string& error );
+
+#endif // GAMECUBECONTROLLER_ARCHIVE
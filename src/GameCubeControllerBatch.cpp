@@ -0,0 +1,632 @@
+// decodes every capture in a directory from the command line, one file per worker thread. each capture
+// is streamed through the same decoder the analyzer runs, so packets match the plugin exactly. writes a
+// packet csv per capture and a report with the counts and timings of every capture and their total.
+// a window of every capture can be decoded again on its own, resuming from the checkpoint before it. the
+// checkpoints of every full decode are kept next to its csv, so a later windowed run skips the full decode
+
+#include "GameCubeControllerArchive.h"
+#include "GameCubeControllerCapture.h"
+#include "GameCubeControllerCheckpoints.h"
+#include "GameCubeControllerDecoder.h"
+#include "GameCubeControllerExportWriter.h"
+#include "GameCubeControllerHost.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <sys/stat.h>
+#endif
+
+namespace
+{
+    struct BatchOptions
+    {
+        BatchOptions()
+            : mDevice( DEVICE_GAMECUBE ), mThreads( 0 ), mArchive( false ), mRawSampleBytes( 0 ), mWindow( false ), mWindowStartS( 0.0 ),
+              mWindowEndS( 0.0 )
+        {
+        }
+
+        std::string mInput;
+        std::string mOutput;
+        JoyBusDevice mDevice;
+        U32 mThreads;
+        bool mArchive;
+        // everything but the path and format, applied to every capture. raw dumps are packed bits
+        // unless mRawSampleBytes is set
+        GameCubeControllerCaptureOptions mCapture;
+        U32 mRawSampleBytes;
+        // the packets starting in [ mWindowStartS, mWindowEndS ) are also written to a csv of their own
+        bool mWindow;
+        double mWindowStartS;
+        double mWindowEndS;
+    };
+
+    // durations in seconds, since captures may differ in sample rate
+    struct TimingStats
+    {
+        TimingStats() : mCount( 0 ), mMin( 0 ), mMax( 0 ), mSum( 0 )
+        {
+        }
+
+        void Add( double value )
+        {
+            mMin = mCount == 0 ? value : std::min( mMin, value );
+            mMax = mCount == 0 ? value : std::max( mMax, value );
+            mSum += value;
+            mCount++;
+        }
+
+        void Add( const TimingStats& other )
+        {
+            if( other.mCount > 0 )
+            {
+                mMin = mCount == 0 ? other.mMin : std::min( mMin, other.mMin );
+                mMax = mCount == 0 ? other.mMax : std::max( mMax, other.mMax );
+                mSum += other.mSum;
+                mCount += other.mCount;
+            }
+        }
+
+        U64 mCount;
+        double mMin;
+        double mMax;
+        double mSum;
+    };
+
+    struct FileReport
+    {
+        FileReport() : mSampleRateHz( 0 ), mPackets( 0 ), mPolls( 0 ), mUnknown( 0 ), mIncomplete( 0 ), mDropped( 0 ), mPollRateHz( 0.0 )
+        {
+        }
+
+        void Add( const FileReport& other )
+        {
+            mPackets += other.mPackets;
+            mPolls += other.mPolls;
+            mUnknown += other.mUnknown;
+            mIncomplete += other.mIncomplete;
+            mDropped += other.mDropped;
+            mLatency.Add( other.mLatency );
+            mTurnaround.Add( other.mTurnaround );
+        }
+
+        std::string mName;
+        std::string mError;
+        U32 mSampleRateHz;
+
+        U64 mPackets;
+        U64 mPolls;
+        U64 mUnknown;
+        // responses cut short, and commands too corrupted to be decoded at all
+        U64 mIncomplete;
+        U64 mDropped;
+
+        // polls, from the start of the command to the end of the response
+        TimingStats mLatency;
+        TimingStats mTurnaround;
+
+        // the host fingerprinted from the first polls. left empty in the total
+        std::string mHost;
+        double mPollRateHz;
+    };
+
+    void WriteHex( GameCubeControllerExportWriter& writer, const U8* bytes, U32 count )
+    {
+        static const char digits[] = "0123456789ABCDEF";
+        for( U32 i = 0; i < count; i++ )
+        {
+            char text[ 3 ] = { digits[ bytes[ i ] >> 4 ], digits[ bytes[ i ] & 0xF ], ' ' };
+            writer.Write( text, i + 1 < count ? 3 : 2 );
+        }
+    }
+
+    void WriteSeconds( GameCubeControllerExportWriter& writer, double seconds )
+    {
+        char text[ 32 ];
+        snprintf( text, sizeof( text ), "%.9f", seconds );
+        writer.Write( text );
+    }
+
+    void WriteMicroseconds( GameCubeControllerExportWriter& writer, double seconds )
+    {
+        char text[ 32 ];
+        snprintf( text, sizeof( text ), "%.3f", seconds * 1000000.0 );
+        writer.Write( text );
+    }
+
+    // counts and times packets while writing them out as they are decoded, so memory doesn't grow with the
+    // capture
+    class BatchSink : public GameCubeControllerDecoderSink
+    {
+      public:
+        BatchSink( GameCubeControllerExportWriter& writer, FileReport& report ) : mWriter( writer ), mReport( report )
+        {
+            mHost.Reset( report.mSampleRateHz );
+            mWriter.Write( "Start [s],End [s],Command,Arguments,Response,Turnaround [us],Status\n" );
+        }
+
+        virtual void OnBit( U64 )
+        {
+        }
+
+        virtual void OnPacket( const JoyBusPacket& packet, const JoyBusCommandInfo* info, U64 start_sample, U64 end_sample )
+        {
+            double rate = mReport.mSampleRateHz;
+            bool complete = info == nullptr || packet.mResponseLength == info->mResponseLength;
+
+            mHost.AddPacket( packet, start_sample );
+
+            mReport.mPackets++;
+            mReport.mUnknown += info == nullptr;
+            mReport.mIncomplete += !complete;
+            if( packet.mHasState )
+            {
+                mReport.mPolls++;
+                mReport.mLatency.Add( ( end_sample - start_sample ) / rate );
+            }
+            if( packet.mHasResponse )
+            {
+                mReport.mTurnaround.Add( ( packet.mResponseStartSample - packet.mCommandEndSample ) / rate );
+            }
+
+            WriteSeconds( mWriter, start_sample / rate );
+            mWriter.Write( "," );
+            WriteSeconds( mWriter, end_sample / rate );
+            mWriter.Write( "," );
+            if( info != nullptr )
+            {
+                mWriter.Write( info->mName );
+            }
+            else
+            {
+                mWriter.Write( "Unknown " );
+                WriteHex( mWriter, &packet.mCommand, 1 );
+            }
+            mWriter.Write( "," );
+            WriteHex( mWriter, packet.mArgs, packet.mArgLength );
+            mWriter.Write( "," );
+            WriteHex( mWriter, packet.mResponse, packet.mResponseLength );
+            mWriter.Write( "," );
+            if( packet.mHasResponse )
+            {
+                WriteMicroseconds( mWriter, ( packet.mResponseStartSample - packet.mCommandEndSample ) / rate );
+            }
+            mWriter.Write( complete ? ",ok\n" : ",incomplete\n" );
+        }
+
+        virtual void OnDrop( U64 start_sample )
+        {
+            mReport.mDropped++;
+
+            WriteSeconds( mWriter, start_sample / static_cast<double>( mReport.mSampleRateHz ) );
+            mWriter.Write( ",,,,,,dropped\n" );
+        }
+
+        // reports the host's fingerprint, classifying whatever was decoded if the capture was too short for a
+        // full one
+        void Finish()
+        {
+            if( mHost.Finish() )
+            {
+                const GameCubeControllerHostProfile& profile = mHost.GetProfile();
+                mReport.mHost = GAMECUBE_HOST_TYPE_NAMES[ profile.mType ];
+                if( profile.mPollInterval != 0 )
+                {
+                    mReport.mPollRateHz = static_cast<double>( mReport.mSampleRateHz ) / profile.mPollInterval;
+                }
+            }
+        }
+
+      protected:
+        GameCubeControllerExportWriter& mWriter;
+        FileReport& mReport;
+        GameCubeControllerHostClassifier mHost;
+    };
+
+    std::string JoinPath( const std::string& directory, const std::string& name )
+    {
+        if( directory.empty() || directory[ directory.size() - 1 ] == '/' || directory[ directory.size() - 1 ] == '\\' )
+        {
+            return directory + name;
+        }
+        return directory + "/" + name;
+    }
+
+    // the regular files of a directory, sorted by name
+    bool ListFiles( const std::string& directory, std::vector<std::string>& names )
+    {
+#ifdef _WIN32
+        WIN32_FIND_DATAA data;
+        HANDLE find = FindFirstFileA( JoinPath( directory, "*" ).c_str(), &data );
+        if( find == INVALID_HANDLE_VALUE )
+        {
+            return false;
+        }
+        do
+        {
+            if( !( data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY ) )
+            {
+                names.push_back( data.cFileName );
+            }
+        } while( FindNextFileA( find, &data ) );
+        FindClose( find );
+#else
+        DIR* dir = opendir( directory.c_str() );
+        if( dir == nullptr )
+        {
+            return false;
+        }
+        while( dirent* entry = readdir( dir ) )
+        {
+            struct stat info;
+            if( stat( JoinPath( directory, entry->d_name ).c_str(), &info ) == 0 && S_ISREG( info.st_mode ) )
+            {
+                names.push_back( entry->d_name );
+            }
+        }
+        closedir( dir );
+#endif
+
+        std::sort( names.begin(), names.end() );
+        return true;
+    }
+
+    bool HasExtension( const std::string& name, const char* extension )
+    {
+        size_t length = strlen( extension );
+        return name.size() >= length && name.compare( name.size() - length, length, extension ) == 0;
+    }
+
+    std::string StripExtension( const std::string& name )
+    {
+        size_t dot = name.rfind( '.' );
+        return dot == std::string::npos || dot == 0 ? name : name.substr( 0, dot );
+    }
+
+    bool IsSelfDescribing( const std::string& name )
+    {
+        return HasExtension( name, ".vcd" ) || HasExtension( name, ".sr" ) || HasExtension( name, ".jba" );
+    }
+
+    // raw dumps can't be recognized, so without a sample rate only self-describing captures are picked up
+    bool IsCapture( const std::string& name, const BatchOptions& options )
+    {
+        return IsSelfDescribing( name ) || ( options.mCapture.mSampleRateHz != 0 && !HasExtension( name, ".csv" ) );
+    }
+
+    U64 GetFileSize( const std::string& path )
+    {
+        std::ifstream file( path.c_str(), std::ios::binary | std::ios::ate );
+        return file ? static_cast<U64>( file.tellg() ) : 0;
+    }
+
+    // seeks back to the last checkpoint before the window instead of decoding from the start again. the
+    // window's packets are written like the full csv. they are only counted in the report if the full
+    // decode was skipped
+    bool DecodeWindow( const BatchOptions& options, GameCubeControllerCapture& capture, const GameCubeControllerCheckpoints& checkpoints,
+                       const std::string& base, FileReport& report, bool count )
+    {
+        GameCubeControllerExportWriter writer( ( base + ".window.csv" ).c_str() );
+        if( !writer.IsOpen() )
+        {
+            report.mError = "Can't write " + base + ".window.csv";
+            return false;
+        }
+
+        FileReport window;
+        window.mSampleRateHz = report.mSampleRateHz;
+        BatchSink sink( writer, count ? report : window );
+        double rate = report.mSampleRateHz;
+        DecodeCaptureWindow( capture, options.mDevice, checkpoints, static_cast<U64>( options.mWindowStartS * rate ),
+                             static_cast<U64>( options.mWindowEndS * rate ), sink );
+        if( count )
+        {
+            sink.Finish();
+        }
+        return true;
+    }
+
+    void DecodeFile( const BatchOptions& options, FileReport& report )
+    {
+        GameCubeControllerCaptureOptions capture_options = options.mCapture;
+        capture_options.mPath = JoinPath( options.mInput, report.mName );
+        if( !IsSelfDescribing( report.mName ) )
+        {
+            capture_options.mFormat = options.mRawSampleBytes != 0 ? CAPTURE_RAW_SAMPLES : CAPTURE_RAW_PACKED;
+            capture_options.mSampleBytes = options.mRawSampleBytes;
+        }
+
+        GameCubeControllerCapture* capture = GameCubeControllerCapture::Open( capture_options, report.mError );
+        if( capture == nullptr )
+        {
+            return;
+        }
+        report.mSampleRateHz = capture->GetSampleRate();
+
+        std::string base = JoinPath( options.mOutput, StripExtension( report.mName ) );
+        std::string checkpoints_path = base + ".ckpt";
+        U64 capture_size = GetFileSize( capture_options.mPath );
+        GameCubeControllerCheckpoints checkpoints;
+        bool window_only =
+            options.mWindow && checkpoints.Load( checkpoints_path.c_str(), capture_size, report.mSampleRateHz, options.mDevice );
+        if( !window_only )
+        {
+            checkpoints.Reset( GameCubeControllerCheckpoints::DEFAULT_INTERVAL );
+            GameCubeControllerExportWriter writer( ( base + ".csv" ).c_str() );
+            if( !writer.IsOpen() )
+            {
+                report.mError = "Can't write " + base + ".csv";
+                delete capture;
+                return;
+            }
+
+            BatchSink sink( writer, report );
+            DecodeCapture( *capture, options.mDevice, sink, &checkpoints );
+            sink.Finish();
+
+            if( !checkpoints.Save( checkpoints_path.c_str(), capture_size, report.mSampleRateHz, options.mDevice ) )
+            {
+                report.mError = "Can't write " + checkpoints_path;
+            }
+        }
+
+        if( options.mWindow && !DecodeWindow( options, *capture, checkpoints, base, report, window_only ) )
+        {
+            delete capture;
+            return;
+        }
+        delete capture;
+
+        // archiving reads the capture once more from the start
+        if( options.mArchive && !HasExtension( report.mName, ".jba" ) )
+        {
+            capture = GameCubeControllerCapture::Open( capture_options, report.mError );
+            if( capture != nullptr )
+            {
+                WriteCaptureArchive( *capture, ( base + ".jba" ).c_str(), report.mError );
+                delete capture;
+            }
+        }
+    }
+
+    void WriteTimingColumns( GameCubeControllerExportWriter& writer, const TimingStats& stats )
+    {
+        for( U32 i = 0; i < 3; i++ )
+        {
+            writer.Write( "," );
+            if( stats.mCount > 0 )
+            {
+                WriteMicroseconds( writer, i == 0 ? stats.mMin : i == 1 ? stats.mSum / stats.mCount : stats.mMax );
+            }
+        }
+    }
+
+    void WriteReportRow( GameCubeControllerExportWriter& writer, const FileReport& report )
+    {
+        writer.Write( report.mName );
+        writer.Write( "," );
+        if( report.mSampleRateHz != 0 )
+        {
+            writer.WriteNumber( report.mSampleRateHz );
+        }
+        const U64 counts[] = { report.mPackets, report.mPolls, report.mUnknown, report.mIncomplete, report.mDropped };
+        for( U32 i = 0; i < sizeof( counts ) / sizeof( counts[ 0 ] ); i++ )
+        {
+            writer.Write( "," );
+            writer.WriteNumber( counts[ i ] );
+        }
+        WriteTimingColumns( writer, report.mLatency );
+        WriteTimingColumns( writer, report.mTurnaround );
+        writer.Write( "," );
+        writer.Write( report.mHost );
+        writer.Write( "," );
+        if( report.mPollRateHz != 0.0 )
+        {
+            char rate[ 32 ];
+            snprintf( rate, sizeof( rate ), "%.2f", report.mPollRateHz );
+            writer.Write( rate );
+        }
+        writer.Write( "," );
+        writer.Write( report.mError );
+        writer.Write( "\n" );
+    }
+
+    bool WriteReport( const BatchOptions& options, const std::vector<FileReport>& reports, FileReport& total )
+    {
+        GameCubeControllerExportWriter writer( JoinPath( options.mOutput, "report.csv" ).c_str() );
+        if( !writer.IsOpen() )
+        {
+            return false;
+        }
+
+        writer.Write( "File,Sample Rate [Hz],Packets,Polls,Unknown,Incomplete,Dropped,Latency Min [us],Latency Mean [us],"
+                      "Latency Max [us],Turnaround Min [us],Turnaround Mean [us],Turnaround Max [us],Host,Poll Rate [Hz],Error\n" );
+        total.mName = "Total";
+        for( size_t i = 0; i < reports.size(); i++ )
+        {
+            WriteReportRow( writer, reports[ i ] );
+            total.Add( reports[ i ] );
+        }
+        WriteReportRow( writer, total );
+        return true;
+    }
+
+    void PrintUsage()
+    {
+        fprintf( stderr,
+                 "usage: GameCubeBatch [options] <capture directory> <output directory>\n"
+                 "  --device gamecube|n64  command set to decode, gamecube by default\n"
+                 "  --threads N            files decoded at once, one per core by default\n"
+                 "  --rate HZ              sample rate of raw dumps. without it only .vcd, .sr and .jba files are read\n"
+                 "  --sample-bytes N       bytes per sample of raw dumps, packed bits by default\n"
+                 "  --channel N            the data line's bit within a sample or vcd signal index\n"
+                 "  --signal NAME          the data line's vcd signal or sigrok probe name\n"
+                 "  --archive              also write every capture as a lossless .jba archive\n"
+                 "  --window START,END     also write the packets starting within START-END seconds to a .window.csv. captures\n"
+                 "                         with a .ckpt from an earlier run are only decoded within the window\n" );
+    }
+
+    bool ParseArguments( int argc, char** argv, BatchOptions& options )
+    {
+        std::vector<std::string> paths;
+        for( int i = 1; i < argc; i++ )
+        {
+            std::string arg = argv[ i ];
+            bool has_value = i + 1 < argc;
+            if( arg == "--device" && has_value )
+            {
+                std::string device = argv[ ++i ];
+                if( device != "gamecube" && device != "n64" )
+                {
+                    return false;
+                }
+                options.mDevice = device == "n64" ? DEVICE_N64 : DEVICE_GAMECUBE;
+            }
+            else if( arg == "--threads" && has_value )
+            {
+                options.mThreads = atoi( argv[ ++i ] );
+            }
+            else if( arg == "--rate" && has_value )
+            {
+                options.mCapture.mSampleRateHz = strtoul( argv[ ++i ], nullptr, 10 );
+            }
+            else if( arg == "--sample-bytes" && has_value )
+            {
+                options.mRawSampleBytes = atoi( argv[ ++i ] );
+            }
+            else if( arg == "--channel" && has_value )
+            {
+                options.mCapture.mChannel = atoi( argv[ ++i ] );
+            }
+            else if( arg == "--signal" && has_value )
+            {
+                options.mCapture.mSignal = argv[ ++i ];
+            }
+            else if( arg == "--archive" )
+            {
+                options.mArchive = true;
+            }
+            else if( arg == "--window" && has_value )
+            {
+                char* end = nullptr;
+                options.mWindowStartS = strtod( argv[ ++i ], &end );
+                if( *end != ',' )
+                {
+                    return false;
+                }
+                options.mWindowEndS = strtod( end + 1, &end );
+                if( *end != '\0' || options.mWindowStartS < 0.0 || options.mWindowEndS <= options.mWindowStartS )
+                {
+                    return false;
+                }
+                options.mWindow = true;
+            }
+            else if( arg.compare( 0, 2, "--" ) == 0 )
+            {
+                return false;
+            }
+            else
+            {
+                paths.push_back( arg );
+            }
+        }
+
+        if( paths.size() != 2 )
+        {
+            return false;
+        }
+        options.mInput = paths[ 0 ];
+        options.mOutput = paths[ 1 ];
+        return true;
+    }
+}
+
+int main( int argc, char** argv )
+{
+    BatchOptions options;
+    if( !ParseArguments( argc, argv, options ) )
+    {
+        PrintUsage();
+        return 2;
+    }
+
+    std::vector<std::string> names;
+    if( !ListFiles( options.mInput, names ) )
+    {
+        fprintf( stderr, "can't read directory %s\n", options.mInput.c_str() );
+        return 1;
+    }
+
+    std::vector<FileReport> reports;
+    for( size_t i = 0; i < names.size(); i++ )
+    {
+        if( IsCapture( names[ i ], options ) )
+        {
+            reports.push_back( FileReport() );
+            reports.back().mName = names[ i ];
+        }
+    }
+
+    U32 threads = options.mThreads != 0 ? options.mThreads : std::max( 1u, std::thread::hardware_concurrency() );
+    threads = static_cast<U32>( std::min<size_t>( threads, reports.size() ) );
+
+    // every worker takes the next file until none are left. a report is only written by its worker
+    std::atomic<size_t> next( 0 );
+    std::mutex print_mutex;
+    std::vector<std::thread> workers;
+    for( U32 i = 0; i < threads; i++ )
+    {
+        workers.push_back( std::thread( [&]() {
+            for( size_t index = next++; index < reports.size(); index = next++ )
+            {
+                FileReport& report = reports[ index ];
+                DecodeFile( options, report );
+
+                std::lock_guard<std::mutex> lock( print_mutex );
+                if( report.mError.empty() )
+                {
+                    printf( "%s: %llu packets, %llu dropped\n", report.mName.c_str(), static_cast<unsigned long long>( report.mPackets ),
+                            static_cast<unsigned long long>( report.mDropped ) );
+                }
+                else
+                {
+                    printf( "%s: %s\n", report.mName.c_str(), report.mError.c_str() );
+                }
+            }
+        } ) );
+    }
+    for( size_t i = 0; i < workers.size(); i++ )
+    {
+        workers[ i ].join();
+    }
+
+    FileReport total;
+    if( !WriteReport( options, reports, total ) )
+    {
+        fprintf( stderr, "can't write the report to %s\n", options.mOutput.c_str() );
+        return 1;
+    }
+
+    size_t failed = 0;
+    for( size_t i = 0; i < reports.size(); i++ )
+    {
+        failed += !reports[ i ].mError.empty();
+    }
+    printf( "%zu captures, %zu failed, %llu packets, %llu incomplete, %llu dropped\n", reports.size(), failed,
+            static_cast<unsigned long long>( total.mPackets ), static_cast<unsigned long long>( total.mIncomplete ),
+            static_cast<unsigned long long>( total.mDropped ) );
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,208 @@
+#include "GameCubeControllerBursts.h"
+
+#include <algorithm>
+#include <cstring>
+
+GameCubeControllerBursts::GameCubeControllerBursts()
+    : mGapSamples( 0 ),
+      mFrameSamples( 0 ),
+      mSessionGapSamples( 0 ),
+      mWindowSamples( 0 ),
+      mLatencyBucketSamples( 1 ),
+      mOpen( false ),
+      mCurrent(),
+      mCurrentLatencyBuckets(),
+      mHasState( false ),
+      mLastState(),
+      mFirstBurst( 0 ),
+      mFirstSession( 0 )
+{
+}
+
+void GameCubeControllerBursts::Reset( U32 sample_rate_hz, double frame_rate_hz, U64 window_samples )
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+
+    mGapSamples = static_cast<U64>( sample_rate_hz * BURST_GAP_S );
+    mFrameSamples = static_cast<U64>( sample_rate_hz / frame_rate_hz );
+    mSessionGapSamples = static_cast<U64>( sample_rate_hz * SESSION_GAP_S );
+    mWindowSamples = window_samples;
+    mLatencyBucketSamples = std::max<U64>( static_cast<U64>( sample_rate_hz * LATENCY_BUCKET_S ), 1 );
+
+    mOpen = false;
+    mHasState = false;
+    mBursts.clear();
+    mFirstBurst = 0;
+    mSessions.clear();
+    mFirstSession = 0;
+}
+
+bool GameCubeControllerBursts::IsNewBurst( U64 start_sample ) const
+{
+    return mOpen && ( start_sample - mCurrent.mEndSample > mGapSamples || start_sample - mCurrent.mStartSample >= mFrameSamples );
+}
+
+bool GameCubeControllerBursts::IsNewSession( U64 start_sample ) const
+{
+    // mCurrent holds the open burst, or the last burst closed. a session gap is always a burst gap too
+    return mSessions.empty() || start_sample - mCurrent.mEndSample > mSessionGapSamples;
+}
+
+U32 GameCubeControllerBursts::CloseBurst()
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+
+    GameCubeControllerSession& session = mSessions.back();
+    session.mEndSample = mCurrent.mEndSample;
+    session.mBurstCount++;
+    session.mPolls += mCurrent.mPolls;
+    session.mStateChanges += mCurrent.mStateChanges;
+    if( mCurrent.mPolls > 0 )
+    {
+        if( session.mMinLatency == 0 || mCurrent.mMinLatency < session.mMinLatency )
+        {
+            session.mMinLatency = mCurrent.mMinLatency;
+        }
+        if( mCurrent.mMaxLatency > session.mMaxLatency )
+        {
+            session.mMaxLatency = mCurrent.mMaxLatency;
+        }
+        for( U32 i = 0; i < LATENCY_BUCKET_COUNT; i++ )
+        {
+            session.mLatencyBuckets[ i ] += mCurrentLatencyBuckets[ i ];
+        }
+    }
+
+    mBursts.push_back( mCurrent );
+    mOpen = false;
+
+    while( mWindowSamples != 0 && mCurrent.mEndSample - mBursts.front().mEndSample > mWindowSamples )
+    {
+        mBursts.pop_front();
+        mFirstBurst++;
+    }
+
+    // the open session is mSessions.back(), which is always kept
+    while( mWindowSamples != 0 && mSessions.size() > 1 && mCurrent.mEndSample - mSessions.front().mEndSample > mWindowSamples )
+    {
+        mSessions.pop_front();
+        mFirstSession++;
+    }
+
+    return mCurrent.mSession;
+}
+
+void GameCubeControllerBursts::AddPacket( const JoyBusPacket& packet, U64 start_sample, U64 end_sample )
+{
+    if( !mOpen )
+    {
+        if( IsNewSession( start_sample ) )
+        {
+            GameCubeControllerSession session = {};
+            session.mStartSample = start_sample;
+            session.mEndSample = start_sample;
+            session.mFirstBurst = mFirstBurst + mBursts.size();
+
+            std::lock_guard<std::mutex> lock( mMutex );
+            if( mSessions.size() == SESSION_LIMIT )
+            {
+                mSessions.pop_front();
+                mFirstSession++;
+            }
+            mSessions.push_back( session );
+        }
+
+        mCurrent.mStartSample = start_sample;
+        mCurrent.mSession = static_cast<U32>( mFirstSession + mSessions.size() - 1 );
+        mCurrent.mPackets = 0;
+        mCurrent.mPolls = 0;
+        mCurrent.mStateChanges = 0;
+        mCurrent.mMinLatency = 0;
+        mCurrent.mMaxLatency = 0;
+        memset( mCurrentLatencyBuckets, 0, sizeof( mCurrentLatencyBuckets ) );
+        mOpen = true;
+    }
+
+    mCurrent.mEndSample = end_sample;
+    mCurrent.mPackets++;
+
+    if( packet.mHasState )
+    {
+        U64 latency = end_sample - start_sample;
+        if( mCurrent.mPolls == 0 || latency < mCurrent.mMinLatency )
+        {
+            mCurrent.mMinLatency = latency;
+        }
+        if( latency > mCurrent.mMaxLatency )
+        {
+            mCurrent.mMaxLatency = latency;
+        }
+        mCurrent.mPolls++;
+        mCurrentLatencyBuckets[ std::min<U64>( latency / mLatencyBucketSamples, LATENCY_BUCKET_COUNT - 1 ) ]++;
+
+        if( mHasState && memcmp( &packet.mState, &mLastState, sizeof( mLastState ) ) != 0 )
+        {
+            mCurrent.mStateChanges++;
+        }
+        mLastState = packet.mState;
+        mHasState = true;
+    }
+}
+
+U64 GameCubeControllerBursts::GetBurstCount()
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+
+    return mFirstBurst + mBursts.size();
+}
+
+U64 GameCubeControllerBursts::GetFirstBurst()
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+
+    return mFirstBurst;
+}
+
+bool GameCubeControllerBursts::GetBurst( U64 index, GameCubeControllerBurst& burst )
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+
+    if( index < mFirstBurst || index - mFirstBurst >= mBursts.size() )
+    {
+        return false;
+    }
+
+    burst = mBursts[ index - mFirstBurst ];
+    return true;
+}
+
+bool GameCubeControllerBursts::GetSession( U32 index, GameCubeControllerSession& session )
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+
+    if( index < mFirstSession || index - mFirstSession >= mSessions.size() )
+    {
+        return false;
+    }
+
+    session = mSessions[ index - mFirstSession ];
+    return true;
+}
+
+U64 GameCubeControllerBursts::GetLatencyPercentile( const GameCubeControllerSession& session, double fraction )
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+
+    U64 polls = 0;
+    for( U32 i = 0; i < LATENCY_BUCKET_COUNT - 1; i++ )
+    {
+        polls += session.mLatencyBuckets[ i ];
+        if( polls >= fraction * session.mPolls )
+        {
+            return std::min( ( i + 1 ) * mLatencyBucketSamples, session.mMaxLatency );
+        }
+    }
+
+    // the last bucket has no upper edge
+    return session.mMaxLatency;
+}
@@ -0,0 +1,105 @@
+#ifndef GAMECUBECONTROLLER_BURSTS
+#define GAMECUBECONTROLLER_BURSTS
+
+#include "GameCubeControllerCommands.h"
+
+#include <deque>
+#include <mutex>
+
+// packets closer together than this are treated as one burst, i.e. one video frame
+static const double BURST_GAP_S = 0.002;
+// polling pauses longer than this start a new session, e.g. a reset or a controller being plugged in
+static const double SESSION_GAP_S = 0.5;
+// poll latencies are counted per session in buckets this wide, the last one also counting every longer
+// poll
+static const double LATENCY_BUCKET_S = 25e-6;
+static const U32 LATENCY_BUCKET_COUNT = 32;
+// at most this many sessions are kept, on top of the results window
+static const U32 SESSION_LIMIT = 1024;
+
+// the packets a console sends for one video frame. times are in samples
+struct GameCubeControllerBurst
+{
+    U64 mStartSample;
+    U64 mEndSample;
+    U32 mSession;
+    U32 mPackets;
+    // packets with a controller state, and how many of them differed from the state before
+    U32 mPolls;
+    U32 mStateChanges;
+    // the shortest and longest poll, from the start of the command to the end of the response
+    U64 mMinLatency;
+    U64 mMaxLatency;
+};
+
+// totals over every burst of a session, which are kept after the bursts themselves are dropped
+struct GameCubeControllerSession
+{
+    U64 mStartSample;
+    U64 mEndSample;
+    U64 mFirstBurst;
+    U64 mBurstCount;
+    U64 mPolls;
+    U64 mStateChanges;
+    U64 mMinLatency;
+    U64 mMaxLatency;
+    U32 mLatencyBuckets[ LATENCY_BUCKET_COUNT ];
+};
+
+// groups packets into bursts following the console's polling cadence, and bursts into sessions. a
+// burst ends at a gap in polling or once it spans a whole video frame, so consoles polling back to
+// back are still split per frame. the decoder commits every closed burst as an analyzer packet and
+// every session as a transaction, so burst n is packet n. with a window, only the bursts ending within
+// that many samples of the newest are kept, and older ones only count towards their session. sessions
+// are dropped the same way, except for the open one, and never more than SESSION_LIMIT are kept
+class GameCubeControllerBursts
+{
+  public:
+    GameCubeControllerBursts();
+
+    void Reset( U32 sample_rate_hz, double frame_rate_hz, U64 window_samples );
+
+    // true if a packet starting at start_sample doesn't belong to the open burst
+    bool IsNewBurst( U64 start_sample ) const;
+    // true if a packet starting at start_sample opens a new session. only meaningful before it's added
+    bool IsNewSession( U64 start_sample ) const;
+    // closes the open burst and returns its session
+    U32 CloseBurst();
+    // adds a packet to the open burst, opening one if needed
+    void AddPacket( const JoyBusPacket& packet, U64 start_sample, U64 end_sample );
+
+    // only closed bursts can be read, and of those only the ones from GetFirstBurst on are kept
+    U64 GetBurstCount();
+    U64 GetFirstBurst();
+    bool GetBurst( U64 index, GameCubeControllerBurst& burst );
+    bool GetSession( U32 index, GameCubeControllerSession& session );
+    // the latency which at least fraction of a session's polls didn't exceed, rounded up to its bucket
+    U64 GetLatencyPercentile( const GameCubeControllerSession& session, double fraction );
+
+  protected:
+    U64 mGapSamples;
+    U64 mFrameSamples;
+    U64 mSessionGapSamples;
+    U64 mWindowSamples;
+    U64 mLatencyBucketSamples;
+
+    bool mOpen;
+    GameCubeControllerBurst mCurrent;
+    // the open burst's polls, added to its session once it's closed
+    U32 mCurrentLatencyBuckets[ LATENCY_BUCKET_COUNT ];
+
+    bool mHasState;
+    GameCubeControllerState mLastState;
+
+    // mBursts[ 0 ] is burst number mFirstBurst
+    std::deque<GameCubeControllerBurst> mBursts;
+    U64 mFirstBurst;
+    // mSessions[ 0 ] is session number mFirstSession
+    std::deque<GameCubeControllerSession> mSessions;
+    U32 mFirstSession;
+
+    // bursts are closed by the worker thread while the tables are being read
+    std::mutex mMutex;
+};
+
+#endif // GAMECUBECONTROLLER_BURSTS
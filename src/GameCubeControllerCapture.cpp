@@ -0,0 +1,1152 @@
+#include "GameCubeControllerCapture.h"
+
+#include "GameCubeControllerArchive.h"
+#include "GameCubeControllerInflate.h"
+#include "GameCubeControllerText.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// edges are handed to the decoder in chunks of roughly this many samples' worth of data
+static const U64 SCAN_BLOCK_BYTES = 1 << 16;
+static const size_t VCD_EDGE_CHUNK = 1 << 16;
+
+static U32 CountTrailingZeros( U64 value )
+{
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward64( &index, value );
+    return index;
+#else
+    return __builtin_ctzll( value );
+#endif
+}
+
+// reads a little endian word. samples are stored in file order, so the first sample ends up in the low
+// bits on every supported host
+static U64 LoadWord( const U8* data )
+{
+    U64 word = 0;
+    for( U32 i = 0; i < 8; i++ )
+    {
+        word |= static_cast<U64>( data[ i ] ) << ( i * 8 );
+    }
+    return word;
+}
+
+static U32 ReadLittleEndian( const U8* data, U32 size )
+{
+    U32 value = 0;
+    for( U32 i = 0; i < size; i++ )
+    {
+        value |= static_cast<U32>( data[ i ] ) << ( i * 8 );
+    }
+    return value;
+}
+
+GameCubeControllerCaptureOptions::GameCubeControllerCaptureOptions()
+    : mFormat( CAPTURE_AUTO ), mChannel( 0 ), mSampleRateHz( 0 ), mSampleBytes( 1 )
+{
+}
+
+GameCubeControllerMappedFile::GameCubeControllerMappedFile()
+    : mData( nullptr ), mSize( 0 )
+#ifdef _WIN32
+      ,
+      mFile( INVALID_HANDLE_VALUE ), mMapping( nullptr )
+#endif
+{
+}
+
+GameCubeControllerMappedFile::~GameCubeControllerMappedFile()
+{
+    Close();
+}
+
+bool GameCubeControllerMappedFile::Open( const char* path, std::string& error )
+{
+    Close();
+
+#ifdef _WIN32
+    mFile = CreateFileA( path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr );
+    LARGE_INTEGER size;
+    if( mFile == INVALID_HANDLE_VALUE || !GetFileSizeEx( mFile, &size ) )
+    {
+        error = std::string( "Unable to open " ) + path;
+        Close();
+        return false;
+    }
+    mSize = size.QuadPart;
+
+    if( mSize > 0 )
+    {
+        mMapping = CreateFileMappingA( mFile, nullptr, PAGE_READONLY, 0, 0, nullptr );
+        mData = mMapping != nullptr ? static_cast<const U8*>( MapViewOfFile( mMapping, FILE_MAP_READ, 0, 0, 0 ) ) : nullptr;
+        if( mData == nullptr )
+        {
+            error = std::string( "Unable to map " ) + path;
+            Close();
+            return false;
+        }
+    }
+#else
+    int fd = open( path, O_RDONLY );
+    struct stat status;
+    if( fd < 0 || fstat( fd, &status ) != 0 )
+    {
+        error = std::string( "Unable to open " ) + path;
+        if( fd >= 0 )
+        {
+            close( fd );
+        }
+        return false;
+    }
+    mSize = status.st_size;
+
+    if( mSize > 0 )
+    {
+        void* data = mmap( nullptr, mSize, PROT_READ, MAP_PRIVATE, fd, 0 );
+        if( data == MAP_FAILED )
+        {
+            error = std::string( "Unable to map " ) + path;
+            close( fd );
+            mSize = 0;
+            return false;
+        }
+        // captures are read front to back exactly once
+        madvise( data, mSize, MADV_SEQUENTIAL );
+        mData = static_cast<const U8*>( data );
+    }
+    close( fd );
+#endif
+
+    return true;
+}
+
+void GameCubeControllerMappedFile::Close()
+{
+#ifdef _WIN32
+    if( mData != nullptr )
+    {
+        UnmapViewOfFile( mData );
+    }
+    if( mMapping != nullptr )
+    {
+        CloseHandle( mMapping );
+    }
+    if( mFile != INVALID_HANDLE_VALUE )
+    {
+        CloseHandle( mFile );
+    }
+    mMapping = nullptr;
+    mFile = INVALID_HANDLE_VALUE;
+#else
+    if( mData != nullptr )
+    {
+        munmap( const_cast<U8*>( mData ), mSize );
+    }
+#endif
+
+    mData = nullptr;
+    mSize = 0;
+}
+
+const U8* GameCubeControllerMappedFile::GetData() const
+{
+    return mData;
+}
+
+U64 GameCubeControllerMappedFile::GetSize() const
+{
+    return mSize;
+}
+
+void GameCubeControllerSampleScanner::Reset( U32 sample_bytes, U32 channel )
+{
+    mSampleBytes = sample_bytes;
+    mChannel = channel;
+    mSampleCount = 0;
+    mStarted = false;
+    mLastBit = 0;
+    mInitialBitState = BIT_LOW;
+}
+
+void GameCubeControllerSampleScanner::Scan( const U8* data, U64 size, std::vector<U64>& edges )
+{
+    if( size == 0 )
+    {
+        return;
+    }
+
+    // the first sample sets the initial level, it isn't an edge
+    if( !mStarted )
+    {
+        mLastBit = mSampleBytes == 0 ? data[ 0 ] & 1 : ( data[ mChannel / 8 ] >> ( mChannel % 8 ) ) & 1;
+        mInitialBitState = mLastBit ? BIT_HIGH : BIT_LOW;
+        mStarted = true;
+    }
+
+    switch( mSampleBytes )
+    {
+    case 0:
+        ScanPacked( data, size, edges );
+        break;
+    case 1:
+    case 2:
+    case 4:
+    case 8:
+        ScanLanes( data, size, edges );
+        break;
+    default:
+        ScanSamples( data, size, edges );
+        break;
+    }
+}
+
+void GameCubeControllerSampleScanner::Seek( U64 sample )
+{
+    mSampleCount = sample;
+    mStarted = false;
+}
+
+BitState GameCubeControllerSampleScanner::GetInitialBitState() const
+{
+    return mInitialBitState;
+}
+
+U64 GameCubeControllerSampleScanner::GetSampleCount() const
+{
+    return mSampleCount;
+}
+
+// every bit is a sample. a bit differs from the one before it exactly where the word differs from
+// itself shifted up by one
+void GameCubeControllerSampleScanner::ScanPacked( const U8* data, U64 size, std::vector<U64>& edges )
+{
+    U64 i = 0;
+    for( ; i + 8 <= size; i += 8 )
+    {
+        U64 word = LoadWord( data + i );
+        U64 transitions = word ^ ( ( word << 1 ) | mLastBit );
+        while( transitions != 0 )
+        {
+            edges.push_back( mSampleCount + CountTrailingZeros( transitions ) );
+            transitions &= transitions - 1;
+        }
+
+        mLastBit = word >> 63;
+        mSampleCount += 64;
+    }
+
+    for( ; i < size; i++ )
+    {
+        for( U32 j = 0; j < 8; j++, mSampleCount++ )
+        {
+            U32 bit = ( data[ i ] >> j ) & 1;
+            if( bit != mLastBit )
+            {
+                edges.push_back( mSampleCount );
+                mLastBit = bit;
+            }
+        }
+    }
+}
+
+// samples of 1, 2, 4 or 8 bytes are lanes of a word. the channel bit of every lane is moved to the
+// bottom of its lane, then compared with the lane below it the same way as packed bits
+void GameCubeControllerSampleScanner::ScanLanes( const U8* data, U64 size, std::vector<U64>& edges )
+{
+    const U32 lane_bits = mSampleBytes * 8;
+    const U32 lanes = 64 / lane_bits;
+
+    U64 lane_mask = 0;
+    for( U32 i = 0; i < lanes; i++ )
+    {
+        lane_mask |= 1ull << ( i * lane_bits );
+    }
+
+    U64 i = 0;
+    for( ; i + 8 <= size; i += 8 )
+    {
+        U64 bits = ( LoadWord( data + i ) >> mChannel ) & lane_mask;
+        U64 transitions = bits ^ ( ( lane_bits < 64 ? bits << lane_bits : 0 ) | mLastBit );
+        while( transitions != 0 )
+        {
+            edges.push_back( mSampleCount + CountTrailingZeros( transitions ) / lane_bits );
+            transitions &= transitions - 1;
+        }
+
+        mLastBit = bits >> ( 64 - lane_bits );
+        mSampleCount += lanes;
+    }
+
+    ScanSamples( data + i, size - i, edges );
+}
+
+void GameCubeControllerSampleScanner::ScanSamples( const U8* data, U64 size, std::vector<U64>& edges )
+{
+    for( U64 i = 0; i + mSampleBytes <= size; i += mSampleBytes, mSampleCount++ )
+    {
+        U32 bit = ( data[ i + mChannel / 8 ] >> ( mChannel % 8 ) ) & 1;
+        if( bit != mLastBit )
+        {
+            edges.push_back( mSampleCount );
+            mLastBit = bit;
+        }
+    }
+}
+
+namespace
+{
+    // a header-less dump of samples
+    class RawCapture : public GameCubeControllerCapture
+    {
+      public:
+        bool Open( const GameCubeControllerCaptureOptions& options, std::string& error )
+        {
+            U32 sample_bytes = options.mFormat == CAPTURE_RAW_SAMPLES ? options.mSampleBytes : 0;
+            if( options.mSampleRateHz == 0 )
+            {
+                error = "Raw captures need a sample rate";
+                return false;
+            }
+            if( sample_bytes == 0 ? options.mChannel != 0 : options.mChannel >= sample_bytes * 8 )
+            {
+                error = "Channel is not part of a sample";
+                return false;
+            }
+            if( !mFile.Open( options.mPath.c_str(), error ) )
+            {
+                return false;
+            }
+
+            mSampleRateHz = options.mSampleRateHz;
+            mSampleBytes = sample_bytes;
+            mScanner.Reset( sample_bytes, options.mChannel );
+            mPosition = 0;
+
+            // keep blocks on sample boundaries
+            mBlockSize = sample_bytes > 1 ? SCAN_BLOCK_BYTES - SCAN_BLOCK_BYTES % sample_bytes : SCAN_BLOCK_BYTES;
+            return true;
+        }
+
+      protected:
+        virtual bool ReadChunk( std::vector<U64>& edges )
+        {
+            edges.clear();
+            while( edges.empty() && mPosition < mFile.GetSize() )
+            {
+                U64 size = std::min( mBlockSize, mFile.GetSize() - mPosition );
+                mScanner.Scan( mFile.GetData() + mPosition, size, edges );
+                mPosition += size;
+            }
+
+            mInitialBitState = mScanner.GetInitialBitState();
+            return !edges.empty();
+        }
+
+        // samples are at fixed offsets, so this lands on the sample itself, or the start of its byte
+        // for packed bits. past the end it lands on the last sample, which still gives the final level
+        virtual void SeekBefore( U64 sample )
+        {
+            U64 samples = mSampleBytes == 0 ? mFile.GetSize() * 8 : mFile.GetSize() / mSampleBytes;
+            sample = std::min( sample, samples > 0 ? samples - 1 : 0 );
+            if( mSampleBytes == 0 )
+            {
+                sample -= sample % 8;
+            }
+
+            mPosition = mSampleBytes == 0 ? sample / 8 : sample * mSampleBytes;
+            mScanner.Seek( sample );
+        }
+
+        GameCubeControllerSampleScanner mScanner;
+        U32 mSampleBytes;
+        U64 mPosition;
+        U64 mBlockSize;
+    };
+
+    // value change dumps. only single-bit scalar changes of the selected signal are used
+    class VcdCapture : public GameCubeControllerCapture
+    {
+      public:
+        bool Open( const GameCubeControllerCaptureOptions& options, std::string& error )
+        {
+            if( !mFile.Open( options.mPath.c_str(), error ) )
+            {
+                return false;
+            }
+
+            mPosition = 0;
+            mTime = 0;
+            mHasValue = false;
+            mLastBit = 0;
+
+            U64 timescale_fs = 0;
+            U32 signal_index = 0;
+            bool found = false;
+
+            std::string token;
+            while( NextToken( token ) && token != "$enddefinitions" )
+            {
+                if( token == "$timescale" )
+                {
+                    std::string scale;
+                    while( NextToken( token ) && token != "$end" )
+                    {
+                        scale += token;
+                    }
+                    timescale_fs = ParseTimescale( scale );
+                }
+                else if( token == "$var" )
+                {
+                    std::string type, size, id, reference;
+                    NextToken( type );
+                    NextToken( size );
+                    NextToken( id );
+                    NextToken( reference );
+                    SkipToEnd();
+
+                    if( size != "1" || found )
+                    {
+                        continue;
+                    }
+                    if( options.mSignal.empty() ? signal_index++ == options.mChannel : reference == options.mSignal )
+                    {
+                        mId = id;
+                        found = true;
+                    }
+                }
+                else if( token[ 0 ] == '$' && token != "$end" )
+                {
+                    SkipToEnd();
+                }
+            }
+
+            if( timescale_fs == 0 )
+            {
+                error = "VCD file has no valid $timescale";
+                return false;
+            }
+            if( !found )
+            {
+                error = "VCD file has no matching 1-bit signal";
+                return false;
+            }
+
+            // sample rates are limited to 32 bits, so anything finer than a nanosecond is rounded to one
+            if( timescale_fs >= 1000000 )
+            {
+                mSampleRateHz = static_cast<U32>( 1000000000000000ull / timescale_fs );
+                mTimeDivisor = 1;
+            }
+            else
+            {
+                mSampleRateHz = 1000000000;
+                mTimeDivisor = 1000000 / timescale_fs;
+            }
+
+            mBodyPosition = mPosition;
+            return true;
+        }
+
+      protected:
+        virtual bool ReadChunk( std::vector<U64>& edges )
+        {
+            edges.clear();
+
+            const U8* data = mFile.GetData();
+            U64 size = mFile.GetSize();
+
+            while( edges.size() < VCD_EDGE_CHUNK )
+            {
+                SkipWhitespace();
+                if( mPosition >= size )
+                {
+                    break;
+                }
+
+                U8 c = data[ mPosition ];
+                if( c == '#' )
+                {
+                    mTime = strtoull( reinterpret_cast<const char*>( data ) + mPosition + 1, nullptr, 10 );
+                    SkipToken();
+                }
+                else if( c == '0' || c == '1' )
+                {
+                    U64 start = ++mPosition;
+                    SkipToken();
+                    if( mId.size() == mPosition - start && memcmp( data + start, mId.data(), mId.size() ) == 0 )
+                    {
+                        AddValue( c - '0', edges );
+                    }
+                }
+                else if( c == 'b' || c == 'B' || c == 'r' || c == 'R' )
+                {
+                    // vector and real values are followed by their identifier
+                    SkipToken();
+                    SkipWhitespace();
+                    SkipToken();
+                }
+                else if( c == '$' )
+                {
+                    std::string token;
+                    NextToken( token );
+                    if( token == "$comment" )
+                    {
+                        SkipToEnd();
+                    }
+                }
+                else
+                {
+                    // x and z leave the line where it was
+                    SkipToken();
+                }
+            }
+
+            return !edges.empty();
+        }
+
+        // value changes are text without an index, so the only safe place to restart is the first one
+        virtual void SeekBefore( U64 )
+        {
+            mPosition = mBodyPosition;
+            mTime = 0;
+            mHasValue = false;
+            mLastBit = 0;
+        }
+
+        void AddValue( U32 bit, std::vector<U64>& edges )
+        {
+            if( !mHasValue )
+            {
+                mHasValue = true;
+                mInitialBitState = bit ? BIT_HIGH : BIT_LOW;
+            }
+            else if( bit != mLastBit )
+            {
+                edges.push_back( mTime / mTimeDivisor );
+            }
+            mLastBit = bit;
+        }
+
+        static U64 ParseTimescale( const std::string& scale )
+        {
+            static const struct
+            {
+                const char* mUnit;
+                U64 mFs;
+            } units[] = { { "fs", 1ull }, { "ps", 1000ull }, { "ns", 1000000ull }, { "us", 1000000000ull }, { "ms", 1000000000000ull },
+                          { "s", 1000000000000000ull } };
+
+            size_t digits = 0;
+            while( digits < scale.size() && scale[ digits ] >= '0' && scale[ digits ] <= '9' )
+            {
+                digits++;
+            }
+
+            U64 count = strtoull( scale.substr( 0, digits ).c_str(), nullptr, 10 );
+            if( count != 1 && count != 10 && count != 100 )
+            {
+                return 0;
+            }
+
+            for( U32 i = 0; i < sizeof( units ) / sizeof( units[ 0 ] ); i++ )
+            {
+                if( scale.compare( digits, std::string::npos, units[ i ].mUnit ) == 0 )
+                {
+                    return count * units[ i ].mFs;
+                }
+            }
+
+            return 0;
+        }
+
+        static bool IsWhitespace( U8 c )
+        {
+            return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+        }
+
+        void SkipWhitespace()
+        {
+            while( mPosition < mFile.GetSize() && IsWhitespace( mFile.GetData()[ mPosition ] ) )
+            {
+                mPosition++;
+            }
+        }
+
+        void SkipToken()
+        {
+            while( mPosition < mFile.GetSize() && !IsWhitespace( mFile.GetData()[ mPosition ] ) )
+            {
+                mPosition++;
+            }
+        }
+
+        bool NextToken( std::string& token )
+        {
+            SkipWhitespace();
+            U64 start = mPosition;
+            SkipToken();
+            token.assign( reinterpret_cast<const char*>( mFile.GetData() ) + start, mPosition - start );
+            return !token.empty();
+        }
+
+        void SkipToEnd()
+        {
+            std::string token;
+            while( NextToken( token ) && token != "$end" )
+            {
+            }
+        }
+
+        std::string mId;
+        U64 mTimeDivisor;
+        U64 mBodyPosition;
+        U64 mPosition;
+        U64 mTime;
+        bool mHasValue;
+        U32 mLastBit;
+    };
+
+    // sigrok session files are zip archives holding a "metadata" ini file and the samples, split over
+    // numbered chunk files. chunks are scanned in place when stored and inflated one at a time
+    // otherwise, so memory use is bounded by the largest chunk
+    class SigrokCapture : public GameCubeControllerCapture
+    {
+      public:
+        bool Open( const GameCubeControllerCaptureOptions& options, std::string& error )
+        {
+            if( !mFile.Open( options.mPath.c_str(), error ) )
+            {
+                return false;
+            }
+            if( !ReadDirectory() )
+            {
+                error = "Not a sigrok session file";
+                return false;
+            }
+
+            std::vector<U8> metadata_buffer;
+            const Entry* metadata = FindEntry( "metadata" );
+            const U8* metadata_data;
+            if( metadata == nullptr || ( metadata_data = GetEntryData( *metadata, metadata_buffer ) ) == nullptr )
+            {
+                error = "Session file has no metadata";
+                return false;
+            }
+
+            std::string text( reinterpret_cast<const char*>( metadata_data ), metadata->mSize );
+            std::string capture_file = GetMetadataValue( text, "capturefile" );
+            U32 sample_bytes = atoi( GetMetadataValue( text, "unitsize" ).c_str() );
+            mSampleRateHz = ParseSampleRate( GetMetadataValue( text, "samplerate" ) );
+
+            U32 channel = options.mChannel;
+            if( !options.mSignal.empty() )
+            {
+                channel = 0;
+                for( U32 i = 1; !GetMetadataValue( text, "probe" + std::to_string( i ) ).empty(); i++ )
+                {
+                    if( GetMetadataValue( text, "probe" + std::to_string( i ) ) == options.mSignal )
+                    {
+                        channel = i;
+                        break;
+                    }
+                }
+                if( channel == 0 )
+                {
+                    error = "Session file has no probe named " + options.mSignal;
+                    return false;
+                }
+                channel--;
+            }
+
+            if( capture_file.empty() || sample_bytes == 0 || mSampleRateHz == 0 )
+            {
+                error = "Session file has no logic data";
+                return false;
+            }
+            if( channel >= sample_bytes * 8 )
+            {
+                error = "Channel is not part of a sample";
+                return false;
+            }
+
+            // the samples are either in the capture file itself or in capture file-1, -2, ...
+            for( size_t i = 0; i < mEntries.size(); i++ )
+            {
+                const std::string& name = mEntries[ i ].mName;
+                if( name == capture_file )
+                {
+                    mChunks.push_back( std::make_pair( 0u, i ) );
+                }
+                else if( name.compare( 0, capture_file.size() + 1, capture_file + "-" ) == 0 )
+                {
+                    mChunks.push_back( std::make_pair( static_cast<U32>( atoi( name.c_str() + capture_file.size() + 1 ) ), i ) );
+                }
+            }
+            std::sort( mChunks.begin(), mChunks.end() );
+
+            mScanner.Reset( sample_bytes, channel );
+            mSampleBytes = sample_bytes;
+            mBlockSize = SCAN_BLOCK_BYTES - SCAN_BLOCK_BYTES % sample_bytes;
+            mNextChunk = 0;
+            mChunkData = nullptr;
+            mChunkSize = 0;
+            mChunkPosition = 0;
+            return true;
+        }
+
+      protected:
+        virtual bool ReadChunk( std::vector<U64>& edges )
+        {
+            edges.clear();
+            while( edges.empty() )
+            {
+                if( mChunkPosition >= mChunkSize )
+                {
+                    if( !NextChunk() )
+                    {
+                        break;
+                    }
+                    continue;
+                }
+
+                U64 size = std::min( mBlockSize, mChunkSize - mChunkPosition );
+                mScanner.Scan( mChunkData + mChunkPosition, size, edges );
+                mChunkPosition += size;
+            }
+
+            mInitialBitState = mScanner.GetInitialBitState();
+            return !edges.empty();
+        }
+
+        // the chunk sizes give the first sample of every chunk, so only the chunk holding the sample is
+        // inflated. past the end, the capture is read again from the start
+        virtual void SeekBefore( U64 sample )
+        {
+            U64 first = 0;
+            mNextChunk = 0;
+            while( mNextChunk < mChunks.size() )
+            {
+                U64 samples = mEntries[ mChunks[ mNextChunk ].second ].mSize / mSampleBytes;
+                if( sample < first + samples )
+                {
+                    break;
+                }
+                first += samples;
+                mNextChunk++;
+            }
+
+            mChunkData = nullptr;
+            mChunkSize = 0;
+            mChunkPosition = 0;
+
+            if( mNextChunk == mChunks.size() )
+            {
+                mNextChunk = 0;
+                mScanner.Seek( 0 );
+                return;
+            }
+
+            if( NextChunk() )
+            {
+                mChunkPosition = ( sample - first ) * mSampleBytes;
+            }
+            mScanner.Seek( sample );
+        }
+
+        struct Entry
+        {
+            std::string mName;
+            U32 mMethod;
+            U64 mCompressedSize;
+            U64 mSize;
+            U64 mLocalHeader;
+        };
+
+        bool ReadDirectory()
+        {
+            const U8* data = mFile.GetData();
+            U64 size = mFile.GetSize();
+            if( size < 22 )
+            {
+                return false;
+            }
+
+            // the end of central directory record is followed by at most a 64k comment
+            U64 end = size - 22;
+            U64 limit = end > 0xFFFF ? end - 0xFFFF : 0;
+            while( ReadLittleEndian( data + end, 4 ) != 0x06054B50 )
+            {
+                if( end == limit )
+                {
+                    return false;
+                }
+                end--;
+            }
+
+            U32 count = ReadLittleEndian( data + end + 10, 2 );
+            U64 position = ReadLittleEndian( data + end + 16, 4 );
+            for( U32 i = 0; i < count; i++ )
+            {
+                if( position + 46 > size || ReadLittleEndian( data + position, 4 ) != 0x02014B50 )
+                {
+                    return false;
+                }
+
+                Entry entry;
+                entry.mMethod = ReadLittleEndian( data + position + 10, 2 );
+                entry.mCompressedSize = ReadLittleEndian( data + position + 20, 4 );
+                entry.mSize = ReadLittleEndian( data + position + 24, 4 );
+                entry.mLocalHeader = ReadLittleEndian( data + position + 42, 4 );
+
+                U32 name_length = ReadLittleEndian( data + position + 28, 2 );
+                U32 extra_length = ReadLittleEndian( data + position + 30, 2 );
+                U32 comment_length = ReadLittleEndian( data + position + 32, 2 );
+                if( position + 46 + name_length > size )
+                {
+                    return false;
+                }
+                entry.mName.assign( reinterpret_cast<const char*>( data ) + position + 46, name_length );
+                mEntries.push_back( entry );
+
+                position += 46 + name_length + extra_length + comment_length;
+            }
+
+            return true;
+        }
+
+        const Entry* FindEntry( const char* name ) const
+        {
+            for( size_t i = 0; i < mEntries.size(); i++ )
+            {
+                if( mEntries[ i ].mName == name )
+                {
+                    return &mEntries[ i ];
+                }
+            }
+            return nullptr;
+        }
+
+        // returns the uncompressed contents of an entry, either in place or inflated into buffer
+        const U8* GetEntryData( const Entry& entry, std::vector<U8>& buffer )
+        {
+            const U8* data = mFile.GetData();
+            U64 size = mFile.GetSize();
+            if( entry.mLocalHeader + 30 > size || ReadLittleEndian( data + entry.mLocalHeader, 4 ) != 0x04034B50 )
+            {
+                return nullptr;
+            }
+
+            U64 start = entry.mLocalHeader + 30 + ReadLittleEndian( data + entry.mLocalHeader + 26, 2 ) +
+                        ReadLittleEndian( data + entry.mLocalHeader + 28, 2 );
+            if( start + entry.mCompressedSize > size )
+            {
+                return nullptr;
+            }
+
+            switch( entry.mMethod )
+            {
+            case 0:
+                return data + start;
+            case 8:
+                buffer.resize( entry.mSize );
+                if( !GameCubeControllerInflate( data + start, entry.mCompressedSize, buffer.data(), entry.mSize ) )
+                {
+                    return nullptr;
+                }
+                return buffer.data();
+            default:
+                return nullptr;
+            }
+        }
+
+        bool NextChunk()
+        {
+            while( mNextChunk < mChunks.size() )
+            {
+                const Entry& entry = mEntries[ mChunks[ mNextChunk++ ].second ];
+                mChunkData = GetEntryData( entry, mChunkBuffer );
+                mChunkSize = mChunkData != nullptr ? entry.mSize : 0;
+                mChunkPosition = 0;
+
+                // a damaged chunk ends the capture rather than shifting every later sample
+                if( mChunkData == nullptr )
+                {
+                    mNextChunk = mChunks.size();
+                    return false;
+                }
+                if( mChunkSize > 0 )
+                {
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        static std::string GetMetadataValue( const std::string& text, const std::string& key )
+        {
+            size_t position = 0;
+            while( ( position = text.find( key + "=", position ) ) != std::string::npos )
+            {
+                if( position == 0 || text[ position - 1 ] == '\n' )
+                {
+                    size_t start = position + key.size() + 1;
+                    size_t end = text.find_first_of( "\r\n", start );
+                    return text.substr( start, end == std::string::npos ? std::string::npos : end - start );
+                }
+                position++;
+            }
+            return std::string();
+        }
+
+        // e.g. "24 MHz"
+        static U32 ParseSampleRate( const std::string& text )
+        {
+            char* unit;
+            double rate = strtod( text.c_str(), &unit );
+            while( *unit == ' ' )
+            {
+                unit++;
+            }
+
+            if( *unit == 'k' )
+            {
+                rate *= 1e3;
+            }
+            else if( *unit == 'M' )
+            {
+                rate *= 1e6;
+            }
+            else if( *unit == 'G' )
+            {
+                rate *= 1e9;
+            }
+
+            return rate > 0 && rate < 4294967296.0 ? static_cast<U32>( rate ) : 0;
+        }
+
+        std::vector<Entry> mEntries;
+        std::vector<std::pair<U32, size_t>> mChunks;
+        size_t mNextChunk;
+
+        std::vector<U8> mChunkBuffer;
+        const U8* mChunkData;
+        U64 mChunkSize;
+        U64 mChunkPosition;
+
+        GameCubeControllerSampleScanner mScanner;
+        U32 mSampleBytes;
+        U64 mBlockSize;
+    };
+
+    bool HasExtension( const std::string& path, const char* extension )
+    {
+        size_t length = strlen( extension );
+        return path.size() >= length && EqualsIgnoreCase( path.substr( path.size() - length ), extension );
+    }
+}
+
+GameCubeControllerCapture::GameCubeControllerCapture() : mSampleRateHz( 0 ), mInitialBitState( BIT_HIGH )
+{
+}
+
+GameCubeControllerCapture::~GameCubeControllerCapture()
+{
+}
+
+GameCubeControllerCapture* GameCubeControllerCapture::Open( const GameCubeControllerCaptureOptions& options, std::string& error )
+{
+    GameCubeControllerCaptureFormat format = options.mFormat;
+    if( format == CAPTURE_AUTO )
+    {
+        format = HasExtension( options.mPath, ".vcd" )   ? CAPTURE_VCD
+                 : HasExtension( options.mPath, ".sr" )  ? CAPTURE_SIGROK
+                 : HasExtension( options.mPath, ".jba" ) ? CAPTURE_ARCHIVE
+                                                         : CAPTURE_RAW_PACKED;
+    }
+    if( format == CAPTURE_ARCHIVE )
+    {
+        return OpenCaptureArchive( options, error );
+    }
+
+    bool ok = false;
+    GameCubeControllerCapture* capture = nullptr;
+    switch( format )
+    {
+    case CAPTURE_VCD:
+    {
+        VcdCapture* vcd = new VcdCapture();
+        ok = vcd->Open( options, error );
+        capture = vcd;
+        break;
+    }
+    case CAPTURE_SIGROK:
+    {
+        SigrokCapture* sigrok = new SigrokCapture();
+        ok = sigrok->Open( options, error );
+        capture = sigrok;
+        break;
+    }
+    default:
+    {
+        RawCapture* raw = new RawCapture();
+        GameCubeControllerCaptureOptions raw_options = options;
+        raw_options.mFormat = format;
+        ok = raw->Open( raw_options, error );
+        capture = raw;
+        break;
+    }
+    }
+
+    if( !ok )
+    {
+        delete capture;
+        return nullptr;
+    }
+
+    return capture;
+}
+
+U32 GameCubeControllerCapture::GetSampleRate() const
+{
+    return mSampleRateHz;
+}
+
+BitState GameCubeControllerCapture::GetInitialBitState() const
+{
+    return mInitialBitState;
+}
+
+bool GameCubeControllerCapture::ReadEdges( std::vector<U64>& edges )
+{
+    if( !mPending.empty() )
+    {
+        edges.swap( mPending );
+        mPending.clear();
+        return true;
+    }
+
+    return ReadChunk( edges );
+}
+
+void GameCubeControllerCapture::Seek( U64 sample )
+{
+    SeekBefore( sample );
+
+    // skip the edges up to and including sample. each one flips the level, starting from the level the
+    // reader landed on
+    U64 skipped = 0;
+    mPending.clear();
+    while( ReadChunk( mPending ) )
+    {
+        size_t passed = std::upper_bound( mPending.begin(), mPending.end(), sample ) - mPending.begin();
+        skipped += passed;
+        mPending.erase( mPending.begin(), mPending.begin() + passed );
+        if( !mPending.empty() )
+        {
+            break;
+        }
+    }
+
+    if( skipped % 2 == 1 )
+    {
+        mInitialBitState = mInitialBitState == BIT_HIGH ? BIT_LOW : BIT_HIGH;
+    }
+}
+
+GameCubeControllerCaptureChannel::GameCubeControllerCaptureChannel( GameCubeControllerCapture* capture )
+    : mCapture( capture ), mNextEdge( 0 ), mSample( 0 ), mExhausted( false ), mAtEnd( false )
+{
+    Fill();
+    mBitState = mCapture->GetInitialBitState();
+}
+
+// makes sure the next edge is buffered. returns false once every edge has been passed
+bool GameCubeControllerCaptureChannel::Fill()
+{
+    if( mNextEdge < mEdges.size() )
+    {
+        return true;
+    }
+    if( mExhausted )
+    {
+        return false;
+    }
+
+    mNextEdge = 0;
+    if( !mCapture->ReadEdges( mEdges ) )
+    {
+        mEdges.clear();
+        mExhausted = true;
+        return false;
+    }
+
+    return true;
+}
+
+U64 GameCubeControllerCaptureChannel::GetSampleNumber()
+{
+    return mSample;
+}
+
+BitState GameCubeControllerCaptureChannel::GetBitState()
+{
+    return mBitState;
+}
+
+void GameCubeControllerCaptureChannel::AdvanceToNextEdge()
+{
+    mSample = GetSampleOfNextEdge();
+    mBitState = mBitState == BIT_HIGH ? BIT_LOW : BIT_HIGH;
+
+    if( mNextEdge < mEdges.size() )
+    {
+        mNextEdge++;
+    }
+    else
+    {
+        mAtEnd = true;
+    }
+}
+
+U64 GameCubeControllerCaptureChannel::GetSampleOfNextEdge()
+{
+    if( Fill() )
+    {
+        return mEdges[ mNextEdge ];
+    }
+
+    return mSample + mCapture->GetSampleRate();
+}
+
+bool GameCubeControllerCaptureChannel::IsAtEnd()
+{
+    return mAtEnd;
+}
+
+void GameCubeControllerCaptureChannel::Seek( U64 sample )
+{
+    mCapture->Seek( sample );
+
+    mEdges.clear();
+    mNextEdge = 0;
+    mSample = sample;
+    mExhausted = false;
+    mAtEnd = false;
+
+    Fill();
+    mBitState = mCapture->GetInitialBitState();
+}
@@ -0,0 +1,158 @@
+#ifndef GAMECUBECONTROLLER_CAPTURE
+#define GAMECUBECONTROLLER_CAPTURE
+
+#include <LogicPublicTypes.h>
+#include <string>
+#include <vector>
+
+// on-disk recordings from other logic analyzers, decoded outside of logic
+enum GameCubeControllerCaptureFormat
+{
+    // picked from the file extension: .vcd, .sr, .jba, otherwise a raw dump of packed bits
+    CAPTURE_AUTO,
+    CAPTURE_VCD,
+    CAPTURE_SIGROK,
+    // written by WriteCaptureArchive
+    CAPTURE_ARCHIVE,
+    // one bit per sample, least significant bit first
+    CAPTURE_RAW_PACKED,
+    // mSampleBytes bytes per sample, one bit per channel
+    CAPTURE_RAW_SAMPLES,
+};
+
+struct GameCubeControllerCaptureOptions
+{
+    GameCubeControllerCaptureOptions();
+
+    std::string mPath;
+    GameCubeControllerCaptureFormat mFormat;
+
+    // the data line: a bit within each sample, or the index of the 1-bit vcd signal. a signal or probe
+    // name takes precedence if set
+    U32 mChannel;
+    std::string mSignal;
+
+    // raw dumps carry no header, so the layout has to be given
+    U32 mSampleRateHz;
+    U32 mSampleBytes;
+};
+
+// a read-only view of a whole file. pages are loaded by the os as they are touched, so captures much
+// larger than memory can be scanned
+class GameCubeControllerMappedFile
+{
+  public:
+    GameCubeControllerMappedFile();
+    ~GameCubeControllerMappedFile();
+
+    bool Open( const char* path, std::string& error );
+    void Close();
+
+    const U8* GetData() const;
+    U64 GetSize() const;
+
+  protected:
+    const U8* mData;
+    U64 mSize;
+#ifdef _WIN32
+    void* mFile;
+    void* mMapping;
+#endif
+};
+
+// turns samples into edges. bits are extracted a 64-bit word at a time and transitions are found by
+// comparing each sample with its neighbour, so runs without edges cost a few instructions per word
+class GameCubeControllerSampleScanner
+{
+  public:
+    // sample_bytes of 0 selects packed bits, one sample per bit
+    void Reset( U32 sample_bytes, U32 channel );
+
+    // scans the next block of samples. samples continue from the end of the previous block
+    void Scan( const U8* data, U64 size, std::vector<U64>& edges );
+    // the next block starts at sample instead. its first sample sets the level, like at the start
+    void Seek( U64 sample );
+
+    BitState GetInitialBitState() const;
+    U64 GetSampleCount() const;
+
+  protected:
+    void ScanPacked( const U8* data, U64 size, std::vector<U64>& edges );
+    void ScanLanes( const U8* data, U64 size, std::vector<U64>& edges );
+    void ScanSamples( const U8* data, U64 size, std::vector<U64>& edges );
+
+    U32 mSampleBytes;
+    U32 mChannel;
+    U64 mSampleCount;
+    bool mStarted;
+    U32 mLastBit;
+    BitState mInitialBitState;
+};
+
+// an importer. edges are handed out in chunks so memory use doesn't depend on the capture length
+class GameCubeControllerCapture
+{
+  public:
+    virtual ~GameCubeControllerCapture();
+
+    // returns nullptr and sets error if the file can't be read
+    static GameCubeControllerCapture* Open( const GameCubeControllerCaptureOptions& options, std::string& error );
+
+    U32 GetSampleRate() const;
+    // the level at the start of the capture, or at the last seek. only valid once the first chunk has
+    // been read
+    BitState GetInitialBitState() const;
+
+    // replaces edges with the samples of the next chunk of edges. returns false once the capture is
+    // exhausted
+    bool ReadEdges( std::vector<U64>& edges );
+
+    // continues reading with the first edge after sample
+    void Seek( U64 sample );
+
+  protected:
+    GameCubeControllerCapture();
+
+    virtual bool ReadChunk( std::vector<U64>& edges ) = 0;
+    // moves the reader to a sample at or before sample. mInitialBitState holds the level there once
+    // the next chunk is read, and isn't changed by the chunks after it
+    virtual void SeekBefore( U64 sample ) = 0;
+
+    GameCubeControllerMappedFile mFile;
+    U32 mSampleRateHz;
+    BitState mInitialBitState;
+
+    // edges left over from the chunk a seek landed in
+    std::vector<U64> mPending;
+};
+
+// presents an imported capture with the subset of AnalyzerChannelData used by the decoder. once the
+// last edge is passed, the line stays idle for another second at a time, which ends any packet
+class GameCubeControllerCaptureChannel
+{
+  public:
+    explicit GameCubeControllerCaptureChannel( GameCubeControllerCapture* capture );
+
+    U64 GetSampleNumber();
+    BitState GetBitState();
+    void AdvanceToNextEdge();
+    U64 GetSampleOfNextEdge();
+
+    bool IsAtEnd();
+
+    // moves to sample, which may be before the current sample
+    void Seek( U64 sample );
+
+  protected:
+    bool Fill();
+
+    GameCubeControllerCapture* mCapture;
+    std::vector<U64> mEdges;
+    size_t mNextEdge;
+    U64 mSample;
+    BitState mBitState;
+    bool mExhausted;
+    bool mAtEnd;
+};
+
+#endif // GAMECUBECONTROLLER_CAPTURE
@@ -0,0 +1,166 @@
+#include "GameCubeControllerCheckpoints.h"
+
+#include "GameCubeControllerExportWriter.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+// the layout of a saved table: the magic, the version, the capture's size, sample rate and device, the
+// interval and the checkpoint count, then the checkpoints
+static const U8 CHECKPOINTS_MAGIC[ 4 ] = { 'J', 'B', 'C', 'K' };
+static const U32 CHECKPOINTS_VERSION = 1;
+static const U32 CHECKPOINTS_HEADER_SIZE = 4 + 4 + 8 + 4 + 4 + 4 + 8;
+static const U32 CHECKPOINT_SIZE = 8 + 8 + 1 + 1 + sizeof( GameCubeControllerState );
+
+static U64 ReadLittleEndian( const U8* data, U32 size )
+{
+    U64 value = 0;
+    for( U32 i = 0; i < size; i++ )
+    {
+        value |= static_cast<U64>( data[ i ] ) << ( i * 8 );
+    }
+    return value;
+}
+
+GameCubeControllerCheckpoint::GameCubeControllerCheckpoint()
+    : mSample( 0 ), mPacketIndex( 0 ), mPollMode( 0 ), mOrigin(), mHasOrigin( false )
+{
+}
+
+void GameCubeControllerCheckpoint::Update( const JoyBusPacket& packet )
+{
+    mPacketIndex++;
+
+    switch( packet.mCommand )
+    {
+    case CMD_STATUS:
+        if( packet.mArgLength >= 1 )
+        {
+            mPollMode = packet.mArgs[ 0 ];
+        }
+        break;
+    case CMD_ORIGIN:
+    case CMD_RECALIBRATE:
+        if( packet.mHasState )
+        {
+            mOrigin = packet.mState;
+            mHasOrigin = true;
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+GameCubeControllerCheckpoints::GameCubeControllerCheckpoints() : mInterval( DEFAULT_INTERVAL )
+{
+}
+
+void GameCubeControllerCheckpoints::Reset( U32 interval )
+{
+    mInterval = interval > 0 ? interval : 1;
+    mCurrent = GameCubeControllerCheckpoint();
+    mCheckpoints.clear();
+}
+
+void GameCubeControllerCheckpoints::AddPacket( const JoyBusPacket& packet, U64 resume_sample )
+{
+    if( mCurrent.mPacketIndex % mInterval == 0 )
+    {
+        mCurrent.mSample = resume_sample;
+        mCheckpoints.push_back( mCurrent );
+    }
+
+    mCurrent.Update( packet );
+}
+
+static bool IsBefore( U64 sample, const GameCubeControllerCheckpoint& checkpoint )
+{
+    return sample < checkpoint.mSample;
+}
+
+bool GameCubeControllerCheckpoints::Find( U64 sample, GameCubeControllerCheckpoint& checkpoint ) const
+{
+    std::vector<GameCubeControllerCheckpoint>::const_iterator next =
+        std::upper_bound( mCheckpoints.begin(), mCheckpoints.end(), sample, IsBefore );
+    if( next == mCheckpoints.begin() )
+    {
+        return false;
+    }
+
+    checkpoint = *( next - 1 );
+    return true;
+}
+
+U64 GameCubeControllerCheckpoints::GetCount() const
+{
+    return mCheckpoints.size();
+}
+
+bool GameCubeControllerCheckpoints::Save( const char* path, U64 capture_size, U32 sample_rate_hz, U32 device ) const
+{
+    GameCubeControllerExportWriter writer( path, true );
+    if( !writer.IsOpen() )
+    {
+        return false;
+    }
+
+    writer.Write( CHECKPOINTS_MAGIC, sizeof( CHECKPOINTS_MAGIC ) );
+    writer.WriteLittleEndian( CHECKPOINTS_VERSION, 4 );
+    writer.WriteLittleEndian( capture_size, 8 );
+    writer.WriteLittleEndian( sample_rate_hz, 4 );
+    writer.WriteLittleEndian( device, 4 );
+    writer.WriteLittleEndian( mInterval, 4 );
+    writer.WriteLittleEndian( mCheckpoints.size(), 8 );
+    for( const GameCubeControllerCheckpoint& checkpoint : mCheckpoints )
+    {
+        writer.WriteLittleEndian( checkpoint.mSample, 8 );
+        writer.WriteLittleEndian( checkpoint.mPacketIndex, 8 );
+        writer.WriteLittleEndian( checkpoint.mPollMode, 1 );
+        writer.WriteLittleEndian( checkpoint.mHasOrigin, 1 );
+        writer.Write( &checkpoint.mOrigin, sizeof( checkpoint.mOrigin ) );
+    }
+
+    return true;
+}
+
+bool GameCubeControllerCheckpoints::Load( const char* path, U64 capture_size, U32 sample_rate_hz, U32 device )
+{
+    std::ifstream file( path, std::ios::binary );
+    if( !file )
+    {
+        return false;
+    }
+    std::vector<U8> data( ( std::istreambuf_iterator<char>( file ) ), std::istreambuf_iterator<char>() );
+
+    if( data.size() < CHECKPOINTS_HEADER_SIZE || memcmp( &data[ 0 ], CHECKPOINTS_MAGIC, sizeof( CHECKPOINTS_MAGIC ) ) != 0 ||
+        ReadLittleEndian( &data[ 4 ], 4 ) != CHECKPOINTS_VERSION || ReadLittleEndian( &data[ 8 ], 8 ) != capture_size ||
+        ReadLittleEndian( &data[ 16 ], 4 ) != sample_rate_hz || ReadLittleEndian( &data[ 20 ], 4 ) != device )
+    {
+        return false;
+    }
+
+    U32 interval = static_cast<U32>( ReadLittleEndian( &data[ 24 ], 4 ) );
+    U64 count = ReadLittleEndian( &data[ 28 ], 8 );
+    if( interval == 0 || ( data.size() - CHECKPOINTS_HEADER_SIZE ) / CHECKPOINT_SIZE != count ||
+        ( data.size() - CHECKPOINTS_HEADER_SIZE ) % CHECKPOINT_SIZE != 0 )
+    {
+        return false;
+    }
+
+    Reset( interval );
+    mCheckpoints.resize( count );
+    const U8* record = &data[ CHECKPOINTS_HEADER_SIZE ];
+    for( GameCubeControllerCheckpoint& checkpoint : mCheckpoints )
+    {
+        checkpoint.mSample = ReadLittleEndian( record, 8 );
+        checkpoint.mPacketIndex = ReadLittleEndian( record + 8, 8 );
+        checkpoint.mPollMode = record[ 16 ];
+        checkpoint.mHasOrigin = record[ 17 ] != 0;
+        memcpy( &checkpoint.mOrigin, record + 18, sizeof( checkpoint.mOrigin ) );
+        record += CHECKPOINT_SIZE;
+    }
+    return true;
+}
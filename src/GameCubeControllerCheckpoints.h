@@ -0,0 +1,61 @@
+#ifndef GAMECUBECONTROLLER_CHECKPOINTS
+#define GAMECUBECONTROLLER_CHECKPOINTS
+
+#include "GameCubeControllerCommands.h"
+
+#include <vector>
+
+// a point between two packets where decoding can start again without scanning from the beginning of
+// the capture, along with the protocol state built up by the packets before it
+struct GameCubeControllerCheckpoint
+{
+    GameCubeControllerCheckpoint();
+
+    // applies the state changes of a packet
+    void Update( const JoyBusPacket& packet );
+
+    // the line is idle here and the decoder is between packets
+    U64 mSample;
+    // the number of packets decoded before this point
+    U64 mPacketIndex;
+
+    // the poll mode requested by the last status command
+    U8 mPollMode;
+    // the neutral stick and trigger positions from the last origin or recalibrate response
+    GameCubeControllerState mOrigin;
+    bool mHasOrigin;
+};
+
+// a sparse table of checkpoints recorded during a full decode, one every mInterval packets
+class GameCubeControllerCheckpoints
+{
+  public:
+    static const U32 DEFAULT_INTERVAL = 1024;
+
+    GameCubeControllerCheckpoints();
+
+    void Reset( U32 interval );
+
+    // called for every decoded packet, in order. resume_sample is where the decoder started looking for
+    // the packet
+    void AddPacket( const JoyBusPacket& packet, U64 resume_sample );
+
+    // finds the last checkpoint at or before sample. returns false if there is none
+    bool Find( U64 sample, GameCubeControllerCheckpoint& checkpoint ) const;
+
+    U64 GetCount() const;
+
+    // keeps the table next to a capture's exports, so a later run can decode a window without a full
+    // decode first. the table only applies to the capture it was recorded from, which is recognized by
+    // its size, sample rate and the device it was decoded as. Load returns false for a missing or
+    // unreadable file, or one recorded from anything else
+    bool Save( const char* path, U64 capture_size, U32 sample_rate_hz, U32 device ) const;
+    bool Load( const char* path, U64 capture_size, U32 sample_rate_hz, U32 device );
+
+  protected:
+    U32 mInterval;
+    GameCubeControllerCheckpoint mCurrent;
+    std::vector<GameCubeControllerCheckpoint> mCheckpoints;
+};
+
+#endif // GAMECUBECONTROLLER_CHECKPOINTS
@@ -0,0 +1,278 @@
+#include "GameCubeControllerCommands.h"
+
+// buttons and device ids are displayed as a 16-bit value, so the first byte on the wire ends up last
+static void AddWord( const char* key, const U8* bytes, FrameV2& frame_v2 )
+{
+    U8 word[ 2 ] = { bytes[ 1 ], bytes[ 0 ] };
+    frame_v2.AddByteArray( key, word, sizeof( word ) );
+}
+
+static void FormatPollArgs( const JoyBusPacket& packet, U32 fields, FrameV2& frame_v2 )
+{
+    if( fields & FIELD_POLL_MODE )
+        frame_v2.AddByte( "Poll Mode", packet.mArgs[ 0 ] );
+    if( fields & FIELD_MOTOR_MODE )
+        frame_v2.AddByte( "Motor Mode", packet.mArgs[ 1 ] );
+}
+
+static void FormatId( const JoyBusPacket& packet, U32, FrameV2& frame_v2 )
+{
+    const U8* r = packet.mResponse;
+    U32 n = packet.mResponseLength;
+
+    if( n >= 2 )
+        AddWord( "Device", r, frame_v2 );
+    if( n >= 3 )
+        frame_v2.AddByte( "Status", r[ 2 ] );
+}
+
+// n64 buttons in wire order: [ 0 ] = A B Z Start Up Down Left Right, [ 1 ] = Reset 0 L R C-Up C-Down C-Left C-Right
+static const char* const N64_BUTTON_NAMES[ BUTTON_COUNT ] = {
+    "D-Right", "D-Left", "D-Down", "D-Up", "Start", "Z", "B", "A", "C-Right", "C-Left", "C-Down", "C-Up", "R", "L", nullptr, "Reset",
+};
+
+static void FormatN64Status( const JoyBusPacket& packet, U32 fields, FrameV2& frame_v2 )
+{
+    const U8* r = packet.mResponse;
+    U32 n = packet.mResponseLength;
+
+    if( n >= 2 && ( fields & FIELD_BUTTONS ) )
+    {
+        if( fields & FIELD_NAMED_BUTTONS )
+            AddButtonNames( r[ 0 ] | ( r[ 1 ] << 8 ), N64_BUTTON_NAMES, frame_v2 );
+        else
+            AddWord( "Buttons", r, frame_v2 );
+    }
+    if( n >= 3 && ( fields & ( 1 << AXIS_STICK_X ) ) )
+        frame_v2.AddInteger( "Joystick X", static_cast<S8>( r[ 2 ] ) );
+    if( n >= 4 && ( fields & ( 1 << AXIS_STICK_Y ) ) )
+        frame_v2.AddInteger( "Joystick Y", static_cast<S8>( r[ 3 ] ) );
+}
+
+// rumble paks are driven by writing to the top of the pak address space: all 0x01 starts the motor and
+// all 0x00 stops it
+static const U16 RUMBLE_ADDRESS = 0xC000;
+
+static void FormatPakAddress( const JoyBusPacket& packet, FrameV2& frame_v2 )
+{
+    U16 address = ( packet.mArgs[ 0 ] << 8 ) | packet.mArgs[ 1 ];
+    frame_v2.AddInteger( "Address", address & 0xFFE0 );
+    frame_v2.AddBoolean( "Address CRC OK", JoyBusAddressWithCrc( address ) == address );
+}
+
+static void FormatPakData( const U8* data, const U8* crc, FrameV2& frame_v2 )
+{
+    frame_v2.AddByteArray( "Data", data, 32 );
+    if( crc != nullptr )
+    {
+        frame_v2.AddByte( "Data CRC", *crc );
+        frame_v2.AddBoolean( "Data CRC OK", JoyBusDataCrc( data ) == *crc );
+    }
+}
+
+static void FormatPakRead( const JoyBusPacket& packet, U32, FrameV2& frame_v2 )
+{
+    FormatPakAddress( packet, frame_v2 );
+
+    if( packet.mResponseLength >= 32 )
+        FormatPakData( packet.mResponse, packet.mResponseLength >= 33 ? &packet.mResponse[ 32 ] : nullptr, frame_v2 );
+}
+
+static void FormatPakWrite( const JoyBusPacket& packet, U32, FrameV2& frame_v2 )
+{
+    FormatPakAddress( packet, frame_v2 );
+    FormatPakData( packet.mArgs + 2, packet.mResponseLength >= 1 ? &packet.mResponse[ 0 ] : nullptr, frame_v2 );
+
+    U16 address = ( ( packet.mArgs[ 0 ] << 8 ) | packet.mArgs[ 1 ] ) & 0xFFE0;
+    if( address >= RUMBLE_ADDRESS )
+        frame_v2.AddBoolean( "Rumble", packet.mArgs[ 2 ] != 0 );
+}
+
+static void FormatGbaRead( const JoyBusPacket& packet, U32, FrameV2& frame_v2 )
+{
+    if( packet.mResponseLength >= 4 )
+        frame_v2.AddByteArray( "Data", packet.mResponse, 4 );
+    if( packet.mResponseLength >= 5 )
+        frame_v2.AddByte( "Status", packet.mResponse[ 4 ] );
+}
+
+static void FormatGbaWrite( const JoyBusPacket& packet, U32, FrameV2& frame_v2 )
+{
+    frame_v2.AddByteArray( "Data", packet.mArgs, 4 );
+
+    if( packet.mResponseLength >= 1 )
+        frame_v2.AddByte( "Status", packet.mResponse[ 0 ] );
+}
+
+static void FormatControllerState( const JoyBusPacket& packet, U32 fields, FrameV2& frame_v2 )
+{
+    if( packet.mHasState )
+        AddControllerState( packet.mState, fields, frame_v2 );
+}
+
+static void FormatPollControllerState( const JoyBusPacket& packet, U32 fields, FrameV2& frame_v2 )
+{
+    FormatPollArgs( packet, fields, frame_v2 );
+    FormatControllerState( packet, fields, frame_v2 );
+}
+
+static void FormatKeyboard( const JoyBusPacket& packet, U32, FrameV2& frame_v2 )
+{
+    const U8* r = packet.mResponse;
+    U32 n = packet.mResponseLength;
+
+    if( n >= 1 )
+        frame_v2.AddByte( "Counter", r[ 0 ] & 0x0F );
+    if( n >= 7 )
+        frame_v2.AddByteArray( "Keys", r + 4, 3 );
+    if( n >= 8 )
+        frame_v2.AddByte( "Checksum", r[ 7 ] );
+}
+
+const char* const JOYBUS_MOTOR_MODE_NAMES[ MOTOR_MODE_COUNT ] = { "Off", "On", "Brake" };
+
+bool GetJoyBusMotorMode( JoyBusDevice device, const JoyBusPacket& packet, JoyBusMotorMode& mode )
+{
+    if( device == DEVICE_N64 )
+    {
+        if( packet.mCommand != CMD_PAK_WRITE || packet.mArgLength < 3 )
+            return false;
+
+        U16 address = ( ( packet.mArgs[ 0 ] << 8 ) | packet.mArgs[ 1 ] ) & 0xFFE0;
+        if( address < RUMBLE_ADDRESS )
+            return false;
+
+        mode = packet.mArgs[ 2 ] != 0 ? MOTOR_ON : MOTOR_OFF;
+        return true;
+    }
+
+    if( ( packet.mCommand != CMD_STATUS && packet.mCommand != CMD_RECALIBRATE && packet.mCommand != CMD_STATUS_LONG ) ||
+        packet.mArgLength < 2 )
+        return false;
+
+    // the low two bits select the mode, 3 isn't used and stops the motor like 0
+    switch( packet.mArgs[ 1 ] & 0x03 )
+    {
+    case 1:
+        mode = MOTOR_ON;
+        break;
+    case 2:
+        mode = MOTOR_BRAKE;
+        break;
+    default:
+        mode = MOTOR_OFF;
+        break;
+    }
+    return true;
+}
+
+void UnpackPacketState( const JoyBusCommandInfo& info, JoyBusPacket& packet )
+{
+    switch( info.mStateLayout )
+    {
+    case STATE_POLLED:
+        packet.mHasState = UnpackControllerState( packet.mResponse, packet.mResponseLength, packet.mArgs[ 0 ], packet.mState );
+        break;
+    case STATE_FULL:
+        packet.mHasState = UnpackControllerState( packet.mResponse, packet.mResponseLength, POLL_MODE_FULL, packet.mState );
+        break;
+    default:
+        packet.mHasState = false;
+        break;
+    }
+}
+
+void FormatUnknownCommand( const JoyBusPacket& packet, FrameV2& frame_v2 )
+{
+    frame_v2.AddByte( "Command", packet.mCommand );
+    if( packet.mArgLength > 0 )
+        frame_v2.AddByteArray( "Arguments", packet.mArgs, packet.mArgLength );
+    if( packet.mResponseLength > 0 )
+        frame_v2.AddByteArray( "Response", packet.mResponse, packet.mResponseLength );
+}
+
+namespace
+{
+    const U8 GAMECUBE_COMMANDS[] = {
+        CMD_ID, CMD_GBA_READ, CMD_GBA_WRITE, CMD_STATUS, CMD_ORIGIN, CMD_RECALIBRATE, CMD_STATUS_LONG, CMD_KEYBOARD, CMD_RESET,
+    };
+    const JoyBusCommandInfo GAMECUBE_COMMAND_INFOS[] = {
+        { "ID", "id", 0, 3, STATE_NONE, FormatId },
+        { "GBA Read", "gba read", 0, 5, STATE_NONE, FormatGbaRead },
+        { "GBA Write", "gba write", 4, 1, STATE_NONE, FormatGbaWrite },
+        { "Status", "status", 2, 8, STATE_POLLED, FormatPollControllerState },
+        { "Origin", "origin", 0, 10, STATE_FULL, FormatControllerState },
+        { "Recalibrate", "recalibrate", 2, 10, STATE_FULL, FormatPollControllerState },
+        { "Status Long", "status (long)", 2, 10, STATE_FULL, FormatPollControllerState },
+        { "Keyboard", "keyboard", 2, 8, STATE_NONE, FormatKeyboard },
+        { "Reset", "reset", 0, 3, STATE_NONE, FormatId },
+    };
+
+    const U8 N64_COMMANDS[] = {
+        CMD_ID, CMD_N64_STATUS, CMD_PAK_READ, CMD_PAK_WRITE, CMD_RESET,
+    };
+    const JoyBusCommandInfo N64_COMMAND_INFOS[] = {
+        { "ID", "id", 0, 3, STATE_NONE, FormatId },
+        { "Status", "n64 status", 0, 4, STATE_NONE, FormatN64Status },
+        { "Pak Read", "pak read", 2, 33, STATE_NONE, FormatPakRead },
+        { "Pak Write", "pak write", 34, 1, STATE_NONE, FormatPakWrite },
+        { "Reset", "reset", 0, 3, STATE_NONE, FormatId },
+    };
+}
+
+JoyBusCommandTable::JoyBusCommandTable( const U8* commands, const JoyBusCommandInfo* infos, U32 count )
+{
+    for( U32 i = 0; i < 256; i++ )
+        mEntries[ i ] = nullptr;
+    for( U32 i = 0; i < count; i++ )
+        mEntries[ commands[ i ] ] = &infos[ i ];
+}
+
+const JoyBusCommandTable GAMECUBE_COMMAND_TABLE( GAMECUBE_COMMANDS, GAMECUBE_COMMAND_INFOS, sizeof( GAMECUBE_COMMANDS ) );
+const JoyBusCommandTable N64_COMMAND_TABLE( N64_COMMANDS, N64_COMMAND_INFOS, sizeof( N64_COMMANDS ) );
+
+const JoyBusCommandInfo* GetJoyBusCommandInfo( JoyBusDevice device, U8 command )
+{
+    switch( device )
+    {
+    case DEVICE_N64:
+        return N64Profile::GetCommandInfo( command );
+    default:
+        return GameCubeProfile::GetCommandInfo( command );
+    }
+}
+
+U16 JoyBusAddressWithCrc( U16 address )
+{
+    static const U8 xor_table[ 16 ] = { 0x00, 0x00, 0x00, 0x00, 0x00, 0x15, 0x1F, 0x0B, 0x16, 0x19, 0x07, 0x0E, 0x1C, 0x0D, 0x1A, 0x01 };
+
+    address &= 0xFFE0;
+
+    U8 crc = 0;
+    for( U32 i = 5; i < 16; i++ )
+    {
+        if( address & ( 1 << i ) )
+            crc ^= xor_table[ i ];
+    }
+
+    return address | crc;
+}
+
+U8 JoyBusDataCrc( const U8* data )
+{
+    // crc-8 with polynomial 0x85, flushed with an extra zero byte
+    U8 crc = 0;
+    for( U32 i = 0; i <= 32; i++ )
+    {
+        for( int j = 7; j >= 0; j-- )
+        {
+            U8 xor_value = ( crc & 0x80 ) ? 0x85 : 0x00;
+            crc <<= 1;
+            if( i < 32 && ( data[ i ] & ( 1 << j ) ) )
+                crc |= 0x01;
+            crc ^= xor_value;
+        }
+    }
+
+    return crc;
+}
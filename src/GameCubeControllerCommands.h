@@ -0,0 +1,147 @@
+#ifndef GAMECUBECONTROLLER_COMMANDS
+#define GAMECUBECONTROLLER_COMMANDS
+
+#include "GameCubeControllerState.h"
+
+#include <AnalyzerResults.h>
+
+// a list of joybus commands can be found here: https://n64brew.dev/wiki/Joybus_Protocol
+enum JoyBusCommand
+{
+    CMD_ID = 0x00,
+    CMD_N64_STATUS = 0x01,
+    CMD_PAK_READ = 0x02,
+    CMD_PAK_WRITE = 0x03,
+    CMD_GBA_READ = 0x14,
+    CMD_GBA_WRITE = 0x15,
+    CMD_STATUS = 0x40,
+    CMD_ORIGIN = 0x41,
+    CMD_RECALIBRATE = 0x42,
+    CMD_STATUS_LONG = 0x43,
+    CMD_KEYBOARD = 0x54,
+    CMD_RESET = 0xFF,
+};
+
+// the largest known transfer is a controller pak write: 2 address bytes and 32 data bytes. unknown
+// commands are captured raw, so leave some headroom for them as well
+static const U32 JOYBUS_MAX_TRANSFER_BYTES = 64;
+
+// the raw contents of a single command/response transaction
+struct JoyBusPacket
+{
+    U8 mCommand;
+    U8 mArgs[ JOYBUS_MAX_TRANSFER_BYTES ];
+    U32 mArgLength;
+    U8 mResponse[ JOYBUS_MAX_TRANSFER_BYTES ];
+    U32 mResponseLength;
+
+    // unpacked once by the decoder for commands which report the controller state
+    GameCubeControllerState mState;
+    bool mHasState;
+
+    // the origin the controller last reported before this packet, kept by the decoder
+    GameCubeControllerState mOrigin;
+    bool mHasOrigin;
+
+    // the command runs from the packet's first falling edge to the rising edge of its stop bit, and the
+    // response from its first falling edge to the end of the packet. the time in between is the
+    // controller's turnaround
+    U64 mCommandEndSample;
+    U64 mResponseStartSample;
+    bool mHasResponse;
+};
+
+// where the layout of a controller state response comes from
+enum JoyBusStateLayout
+{
+    STATE_NONE,
+    STATE_POLLED,
+    STATE_FULL,
+};
+
+// describes how to decode a command. the argument and response lengths exclude the command byte
+// and the stop bits
+struct JoyBusCommandInfo
+{
+    const char* mName;
+    const char* mFrameType;
+    U32 mArgLength;
+    U32 mResponseLength;
+    JoyBusStateLayout mStateLayout;
+
+    // adds the decoded fields selected by the FIELD_ mask to a frame. fields are only added for the bytes
+    // which were actually received, so this must tolerate a truncated response
+    void ( *mFormat )( const JoyBusPacket& packet, U32 fields, FrameV2& frame_v2 );
+};
+
+// the console family whose command set is decoded
+enum JoyBusDevice
+{
+    DEVICE_GAMECUBE = 0,
+    DEVICE_N64 = 1,
+};
+
+// maps every command byte to its layout, or nullptr if the command is not known. unknown commands are
+// decoded as raw bytes
+struct JoyBusCommandTable
+{
+    JoyBusCommandTable( const U8* commands, const JoyBusCommandInfo* infos, U32 count );
+
+    const JoyBusCommandInfo* mEntries[ 256 ];
+};
+
+extern const JoyBusCommandTable GAMECUBE_COMMAND_TABLE;
+extern const JoyBusCommandTable N64_COMMAND_TABLE;
+
+// device profiles select the command set at compile time. the decoder is instantiated once per
+// profile, so a lookup is a single load from a fixed table and the unused profile costs nothing
+struct GameCubeProfile
+{
+    static const JoyBusDevice Device = DEVICE_GAMECUBE;
+
+    static const JoyBusCommandInfo* GetCommandInfo( U8 command )
+    {
+        return GAMECUBE_COMMAND_TABLE.mEntries[ command ];
+    }
+};
+
+struct N64Profile
+{
+    static const JoyBusDevice Device = DEVICE_N64;
+
+    static const JoyBusCommandInfo* GetCommandInfo( U8 command )
+    {
+        return N64_COMMAND_TABLE.mEntries[ command ];
+    }
+};
+
+// runtime lookup for code outside of the decoder, such as bubble text generation
+const JoyBusCommandInfo* GetJoyBusCommandInfo( JoyBusDevice device, U8 command );
+
+// controller pak addresses carry a 5-bit crc in their low bits, and data blocks are followed by an
+// 8-bit crc. see https://n64brew.dev/wiki/Controller_Pak
+U16 JoyBusAddressWithCrc( U16 address );
+U8 JoyBusDataCrc( const U8* data );
+
+// what a command asks of the rumble motor. gamecube polls carry a motor mode with every status command,
+// n64 rumble paks are switched by writes to the rumble address
+enum JoyBusMotorMode
+{
+    MOTOR_OFF = 0,
+    MOTOR_ON = 1,
+    MOTOR_BRAKE = 2,
+    MOTOR_MODE_COUNT,
+};
+
+extern const char* const JOYBUS_MOTOR_MODE_NAMES[ MOTOR_MODE_COUNT ];
+
+// returns false if the packet doesn't set the motor
+bool GetJoyBusMotorMode( JoyBusDevice device, const JoyBusPacket& packet, JoyBusMotorMode& mode );
+
+// fills in the controller state of a packet whose command reports one
+void UnpackPacketState( const JoyBusCommandInfo& info, JoyBusPacket& packet );
+
+// adds the fields of a command with an unknown layout to a frame
+void FormatUnknownCommand( const JoyBusPacket& packet, FrameV2& frame_v2 );
+
+#endif // GAMECUBECONTROLLER_COMMANDS
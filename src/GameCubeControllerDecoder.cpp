@@ -0,0 +1,586 @@
+#include "GameCubeControllerDecoder.h"
+
+#include "GameCubeControllerCapture.h"
+#include "GameCubeControllerEdgeCache.h"
+#include "GameCubeControllerEdgeStream.h"
+
+// only imported captures and pushed edges run out. past their end the line idles, which fails the
+// packet being decoded without anything being wrong with it
+template <class Channel>
+static bool IsPastEnd( Channel* )
+{
+    return false;
+}
+
+static bool IsPastEnd( GameCubeControllerCaptureChannel* channel )
+{
+    return channel->IsAtEnd();
+}
+
+static bool IsPastEnd( GameCubeControllerEdgeStream* channel )
+{
+    return channel->IsAtEnd();
+}
+
+template <class Channel>
+GameCubeControllerDecoder<Channel>::GameCubeControllerDecoder( Channel* channel, U32 sample_rate_hz, GameCubeControllerDecoderSink* sink )
+    : mGamecube( channel ),
+      mSampleRateHz( sample_rate_hz ),
+      mSink( sink ),
+      mOneBitSamples( JoyBusNsToSamples( JOYBUS_ONE_BIT_NS, sample_rate_hz ) ),
+      mStopBitSamples( JoyBusNsToSamples( JOYBUS_STOP_BIT_NS, sample_rate_hz ) ),
+      mMaxPulseSamples( JoyBusNsToSamples( JOYBUS_MAX_PULSE_NS, sample_rate_hz ) ),
+      mIdleSamples( JoyBusNsToSamples( JOYBUS_IDLE_NS, sample_rate_hz ) ),
+      mCheckpoints( nullptr ),
+      mDecodedTransmission( false ),
+      mDecodedReception( false ),
+      mCommandEndSample( 0 ),
+      mResponseStartSample( 0 )
+{
+}
+
+template <class Channel>
+void GameCubeControllerDecoder<Channel>::Start()
+{
+    AdvanceToEndOfPacket();
+}
+
+template <class Channel>
+void GameCubeControllerDecoder<Channel>::SetCheckpoints( GameCubeControllerCheckpoints* checkpoints )
+{
+    mCheckpoints = checkpoints;
+}
+
+template <class Channel>
+const GameCubeControllerCheckpoint& GameCubeControllerDecoder<Channel>::GetProtocolState() const
+{
+    return mProtocolState;
+}
+
+template <class Channel>
+void GameCubeControllerDecoder<Channel>::SetProtocolState( const GameCubeControllerCheckpoint& state )
+{
+    mProtocolState = state;
+}
+
+// saturates rather than wrapping if the edges are out of order
+template <class Channel>
+U64 GameCubeControllerDecoder<Channel>::GetPulseWidth( U64 start_edge, U64 end_edge )
+{
+    return end_edge > start_edge ? end_edge - start_edge : 0;
+}
+
+// advances to the rising edge at the end of a packet
+template <class Channel>
+void GameCubeControllerDecoder<Channel>::AdvanceToEndOfPacket()
+{
+    if( mGamecube->GetBitState() == BIT_LOW )
+    {
+        mGamecube->AdvanceToNextEdge();
+    }
+
+    // if a complete packet was received successfully, we're already at the end of the packet
+    if( mDecodedReception )
+    {
+        mDecodedReception = false;
+        return;
+    }
+
+    // otherwise, something was corrupted. synchronize to at least 100us of inactivity.
+    // this way, we can be sure we're at the beginning of a transmission and not in between
+    // a transmission and reception
+    while( GetPulseWidth( mGamecube->GetSampleNumber(), mGamecube->GetSampleOfNextEdge() ) < mIdleSamples )
+    {
+        mGamecube->AdvanceToNextEdge();
+        mGamecube->AdvanceToNextEdge();
+    }
+}
+
+// advances to the falling edge of the next bit in a packet
+template <class Channel>
+bool GameCubeControllerDecoder<Channel>::AdvanceToNextBitInPacket()
+{
+    // if the transmission from the host completed, the controller has ~100us to respond
+    // in this condition, provide the extra leniency
+    bool turnaround = mDecodedTransmission;
+    U64 limit = turnaround ? mIdleSamples : mMaxPulseSamples;
+    mDecodedTransmission = false;
+
+    if( GetPulseWidth( mGamecube->GetSampleNumber(), mGamecube->GetSampleOfNextEdge() ) < limit )
+    {
+        mGamecube->AdvanceToNextEdge();
+        if( turnaround )
+        {
+            mResponseStartSample = mGamecube->GetSampleNumber();
+        }
+        return true;
+    }
+
+    return false;
+}
+
+template <class Channel>
+template <class Profile>
+void GameCubeControllerDecoder<Channel>::DecodeNext()
+{
+    // the line is idle here and nothing carries over from the previous packet, so decoding can resume
+    // from this sample later on
+    U64 resume_sample = mGamecube->GetSampleNumber();
+
+    // traverse to the first falling edge
+    mGamecube->AdvanceToNextEdge();
+    U64 start_sample = mGamecube->GetSampleNumber();
+
+    JoyBusPacket packet;
+    packet.mArgLength = packet.mResponseLength = 0;
+    packet.mHasState = false;
+    packet.mOrigin = mProtocolState.mOrigin;
+    packet.mHasOrigin = mProtocolState.mHasOrigin;
+    mCommandEndSample = mResponseStartSample = 0;
+
+    // try to decode the command
+    if( !DecodeByte( packet.mCommand ) )
+    {
+        if( !IsPastEnd( mGamecube ) )
+        {
+            mSink->OnDrop( start_sample );
+        }
+        AdvanceToEndOfPacket();
+        return;
+    }
+
+    // commands with a known layout are decoded by length, everything else is captured raw until the
+    // stop bits so unknown traffic is still visible and doesn't force a resynchronization
+    const JoyBusCommandInfo* info = Profile::GetCommandInfo( packet.mCommand );
+    bool transmitted = false;
+    bool ok = info != nullptr ? DecodePacket( *info, packet, transmitted ) : DecodeUnknownPacket( packet, transmitted );
+
+    // drop the packet if the command itself was corrupted
+    if( !transmitted )
+    {
+        if( !IsPastEnd( mGamecube ) )
+        {
+            mSink->OnDrop( start_sample );
+        }
+        AdvanceToEndOfPacket();
+        return;
+    }
+
+    mDecodedReception = ok;
+    AdvanceToEndOfPacket();
+
+    U64 end_sample = mGamecube->GetSampleNumber();
+
+    packet.mCommandEndSample = mCommandEndSample;
+    packet.mResponseStartSample = mResponseStartSample;
+    packet.mHasResponse = mResponseStartSample != 0;
+
+    if( info != nullptr )
+    {
+        UnpackPacketState( *info, packet );
+    }
+
+    if( mCheckpoints != nullptr )
+    {
+        mCheckpoints->AddPacket( packet, resume_sample );
+    }
+    mProtocolState.Update( packet );
+
+    mSink->OnPacket( packet, info, start_sample, end_sample );
+}
+
+// decodes the arguments and response of a command with a known layout. transmitted is set once the
+// command's stop bit is decoded. returns true if the complete response was received
+template <class Channel>
+bool GameCubeControllerDecoder<Channel>::DecodePacket( const JoyBusCommandInfo& info, JoyBusPacket& packet, bool& transmitted )
+{
+    // command args
+    for( packet.mArgLength = 0; packet.mArgLength < info.mArgLength; packet.mArgLength++ )
+    {
+        if( !( AdvanceToNextBitInPacket() && DecodeByte( packet.mArgs[ packet.mArgLength ] ) ) )
+        {
+            return false;
+        }
+    }
+
+    // command stop bit
+    if( !( AdvanceToNextBitInPacket() && DecodeStopBit() ) )
+    {
+        return false;
+    }
+    transmitted = mDecodedTransmission = true;
+    mCommandEndSample = mGamecube->GetSampleNumber();
+
+    // response
+    for( packet.mResponseLength = 0; packet.mResponseLength < info.mResponseLength; packet.mResponseLength++ )
+    {
+        if( !( AdvanceToNextBitInPacket() && DecodeByte( packet.mResponse[ packet.mResponseLength ] ) ) )
+        {
+            return false;
+        }
+    }
+
+    return AdvanceToNextBitInPacket() && DecodeStopBit();
+}
+
+// decodes a command with an unknown layout. the bits are collected until the line goes idle and split
+// into bytes afterwards, since the position of the host stop bit isn't known up front. transmitted is
+// set once the command's stop bit is found. returns true if a complete response was received
+template <class Channel>
+bool GameCubeControllerDecoder<Channel>::DecodeUnknownPacket( JoyBusPacket& packet, bool& transmitted )
+{
+    U32 count;
+    if( !( AdvanceToNextBitInPacket() && DecodeRawBits( count ) ) )
+    {
+        return false;
+    }
+
+    U32 stop;
+    if( count % 8 == 1 )
+    {
+        // only the host transmitted, or the controller took long enough to respond that the line idled
+        stop = count - 1;
+    }
+    else if( count % 8 == 2 && count >= 10 )
+    {
+        // the controller responded quickly enough that both transfers ran together. the turnaround is
+        // the longest high time following a stop bit on a byte boundary that leaves room for a response
+        bool found = false;
+        U64 longest = 0;
+        for( U32 i = 0; i + 10 <= count; i += 8 )
+        {
+            U64 high_time = mRawBitFallingEdges[ i + 1 ] - mRawBitRisingEdges[ i ];
+            if( IsRawStopBit( i ) && ( !found || high_time > longest ) )
+            {
+                found = true;
+                longest = high_time;
+                stop = i;
+            }
+        }
+
+        if( !found )
+        {
+            return false;
+        }
+    }
+    else
+    {
+        return false;
+    }
+
+    if( !IsRawStopBit( stop ) || stop / 8 > JOYBUS_MAX_TRANSFER_BYTES )
+    {
+        return false;
+    }
+
+    packet.mArgLength = stop / 8;
+    PackRawBits( 0, packet.mArgLength, packet.mArgs );
+    transmitted = true;
+    mCommandEndSample = mRawBitRisingEdges[ stop ];
+
+    U32 first = stop + 1;
+    if( first < count )
+    {
+        mResponseStartSample = mRawBitFallingEdges[ first ];
+    }
+    else
+    {
+        // the response is a separate transfer, give the controller the usual time to respond
+        mDecodedTransmission = true;
+        if( !( AdvanceToNextBitInPacket() && DecodeRawBits( count ) ) || count % 8 != 1 )
+        {
+            return false;
+        }
+        first = 0;
+    }
+
+    U32 response_length = ( count - 1 - first ) / 8;
+    if( !IsRawStopBit( count - 1 ) || response_length > JOYBUS_MAX_TRANSFER_BYTES )
+    {
+        return false;
+    }
+
+    packet.mResponseLength = response_length;
+    PackRawBits( first, packet.mResponseLength, packet.mResponse );
+
+    return true;
+}
+
+// records the edges of every bit until the line goes idle. on entry, the current sample should be a
+// falling edge and this function will return on the rising edge of the last bit
+template <class Channel>
+bool GameCubeControllerDecoder<Channel>::DecodeRawBits( U32& count )
+{
+    count = 0;
+    while( count < MAX_RAW_BITS )
+    {
+        U64 falling_edge_sample = mRawBitFallingEdges[ count ] = mGamecube->GetSampleNumber();
+        mGamecube->AdvanceToNextEdge();
+        U64 rising_edge_sample = mRawBitRisingEdges[ count ] = mGamecube->GetSampleNumber();
+
+        if( GetPulseWidth( falling_edge_sample, rising_edge_sample ) >= mMaxPulseSamples )
+        {
+            return false;
+        }
+        count++;
+
+        if( !AdvanceToNextBitInPacket() )
+        {
+            mRawBitFallingEdges[ count ] = mGamecube->GetSampleOfNextEdge();
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// uses the same leniency as DecodeStopBit
+template <class Channel>
+bool GameCubeControllerDecoder<Channel>::IsRawStopBit( U32 index )
+{
+    return GetPulseWidth( mRawBitFallingEdges[ index ], mRawBitRisingEdges[ index ] ) < mStopBitSamples;
+}
+
+// converts recorded bits into bytes, adding the same bit indicators as DecodeDataBit
+template <class Channel>
+void GameCubeControllerDecoder<Channel>::PackRawBits( U32 first, U32 count, U8* bytes )
+{
+    for( U32 i = 0; i < count; i++ )
+    {
+        U8 byte = 0;
+        for( U32 j = 0; j < 8; j++ )
+        {
+            U32 index = first + i * 8 + j;
+            bool bit = GetPulseWidth( mRawBitFallingEdges[ index ], mRawBitRisingEdges[ index ] ) < mOneBitSamples;
+            byte |= bit << ( 7 - j );
+
+            U64 middle_sample = ( mRawBitFallingEdges[ index ] + mRawBitFallingEdges[ index + 1 ] ) / 2;
+            mSink->OnBit( middle_sample );
+        }
+        bytes[ i ] = byte;
+    }
+}
+
+// attempts to decode a byte. the current sample should be a falling edge and this
+// function will return on a rising edge
+template <class Channel>
+bool GameCubeControllerDecoder<Channel>::DecodeByte( U8& byte )
+{
+    byte = 0;
+    for( U8 i = 0; i < 8; i++ )
+    {
+        bool bit;
+        if( !DecodeDataBit( bit ) )
+        {
+            return false;
+        }
+
+        byte |= bit << ( 7 - i );
+
+        if( i < 7 )
+        {
+            // advance to the next falling edge iff
+            // - there are more bits to process in the current byte
+            // - the last bit was successful
+            mGamecube->AdvanceToNextEdge();
+        }
+    }
+
+    return true;
+}
+
+// attempts to decode a single bit. on entry, the current sample should be a falling edge and this
+// function will return on a rising edge
+template <class Channel>
+bool GameCubeControllerDecoder<Channel>::DecodeDataBit( bool& bit )
+{
+    U64 starting_sample, ending_sample, rising_edge_sample, falling_edge_sample;
+
+    // determine whether the bit is a 1 or 0 based on the duration of the low time
+    starting_sample = falling_edge_sample = mGamecube->GetSampleNumber();
+    mGamecube->AdvanceToNextEdge();
+    rising_edge_sample = mGamecube->GetSampleNumber();
+
+    U64 low_time = GetPulseWidth( falling_edge_sample, rising_edge_sample );
+
+    if( low_time >= mMaxPulseSamples )
+    {
+        return false;
+    }
+    else
+    {
+        bit = low_time < mOneBitSamples;
+
+        // make sure the high time is reasonable. peek at the next falling edge, but don't
+        // actually advance to it yet, in case something is wrong.
+        ending_sample = falling_edge_sample = mGamecube->GetSampleOfNextEdge();
+        U64 high_time = GetPulseWidth( rising_edge_sample, falling_edge_sample );
+
+        if( high_time >= mMaxPulseSamples )
+        {
+            return false;
+        }
+
+        // add an indicator showing the bit value
+        U64 middle_sample = ( starting_sample + ending_sample ) / 2;
+        mSink->OnBit( middle_sample );
+    }
+
+    return true;
+}
+
+// attempt to detect a stop bit, which is a single "1" bit where the high time doesn't matter.
+// on entry, the current sample should be a falling edge and this function will return on a rising
+// edge
+template <class Channel>
+bool GameCubeControllerDecoder<Channel>::DecodeStopBit()
+{
+    U64 falling_edge_sample = mGamecube->GetSampleNumber();
+    mGamecube->AdvanceToNextEdge();
+    U64 rising_edge_sample = mGamecube->GetSampleNumber();
+
+    U64 low_time = GetPulseWidth( falling_edge_sample, rising_edge_sample );
+
+    // after observing an OEM controller, the low-time of a stop bit tended to be more than an
+    // average "1" but less than a "0". therefore, we add a bit of leniency.
+    return low_time < mStopBitSamples;
+}
+
+template <class Profile>
+static void DecodeCaptureWithProfile( GameCubeControllerCapture& capture, GameCubeControllerDecoderSink& sink,
+                                      GameCubeControllerCheckpoints* checkpoints )
+{
+    GameCubeControllerCaptureChannel channel( &capture );
+    GameCubeControllerDecoder<GameCubeControllerCaptureChannel> decoder( &channel, capture.GetSampleRate(), &sink );
+    decoder.SetCheckpoints( checkpoints );
+    decoder.Start();
+
+    while( !channel.IsAtEnd() )
+    {
+        decoder.template DecodeNext<Profile>();
+    }
+}
+
+void DecodeCapture( GameCubeControllerCapture& capture, JoyBusDevice device, GameCubeControllerDecoderSink& sink,
+                    GameCubeControllerCheckpoints* checkpoints )
+{
+    switch( device )
+    {
+    case DEVICE_N64:
+        DecodeCaptureWithProfile<N64Profile>( capture, sink, checkpoints );
+        break;
+    default:
+        DecodeCaptureWithProfile<GameCubeProfile>( capture, sink, checkpoints );
+        break;
+    }
+}
+
+namespace
+{
+    // passes on what falls inside the window. packets between the checkpoint and the window only update
+    // the state handed to OnResume
+    class WindowSink : public GameCubeControllerDecoderSink
+    {
+      public:
+        WindowSink( GameCubeControllerDecoderSink& sink, const GameCubeControllerCheckpoint& checkpoint, U64 start_sample, U64 end_sample )
+            : mSink( sink ), mState( checkpoint ), mStartSample( start_sample ), mEndSample( end_sample ), mResumed( false )
+        {
+        }
+
+        virtual void OnBit( U64 sample )
+        {
+            if( sample >= mStartSample && sample < mEndSample )
+            {
+                mSink.OnBit( sample );
+            }
+        }
+
+        virtual void OnPacket( const JoyBusPacket& packet, const JoyBusCommandInfo* info, U64 start_sample, U64 end_sample )
+        {
+            if( start_sample < mStartSample || start_sample >= mEndSample )
+            {
+                mState.Update( packet );
+                return;
+            }
+
+            if( !mResumed )
+            {
+                mSink.OnResume( mState );
+                mResumed = true;
+            }
+            mSink.OnPacket( packet, info, start_sample, end_sample );
+        }
+
+        virtual void OnDrop( U64 start_sample )
+        {
+            if( start_sample >= mStartSample && start_sample < mEndSample )
+            {
+                mSink.OnDrop( start_sample );
+            }
+        }
+
+      protected:
+        GameCubeControllerDecoderSink& mSink;
+        GameCubeControllerCheckpoint mState;
+        U64 mStartSample;
+        U64 mEndSample;
+        bool mResumed;
+    };
+}
+
+template <class Profile>
+static void DecodeCaptureWindowWithProfile( GameCubeControllerCapture& capture, const GameCubeControllerCheckpoints& checkpoints,
+                                            U64 start_sample, U64 end_sample, GameCubeControllerDecoderSink& sink )
+{
+    GameCubeControllerCheckpoint checkpoint;
+    bool found = checkpoints.Find( start_sample, checkpoint );
+
+    WindowSink window( sink, checkpoint, start_sample, end_sample );
+    GameCubeControllerCaptureChannel channel( &capture );
+    GameCubeControllerDecoder<GameCubeControllerCaptureChannel> decoder( &channel, capture.GetSampleRate(), &window );
+
+    // without a checkpoint before the window, decoding starts from the beginning as usual
+    channel.Seek( found ? checkpoint.mSample : 0 );
+    if( found )
+    {
+        decoder.SetProtocolState( checkpoint );
+    }
+    else
+    {
+        decoder.Start();
+    }
+
+    while( !channel.IsAtEnd() && channel.GetSampleNumber() < end_sample )
+    {
+        decoder.template DecodeNext<Profile>();
+    }
+}
+
+void DecodeCaptureWindow( GameCubeControllerCapture& capture, JoyBusDevice device, const GameCubeControllerCheckpoints& checkpoints,
+                          U64 start_sample, U64 end_sample, GameCubeControllerDecoderSink& sink )
+{
+    switch( device )
+    {
+    case DEVICE_N64:
+        DecodeCaptureWindowWithProfile<N64Profile>( capture, checkpoints, start_sample, end_sample, sink );
+        break;
+    default:
+        DecodeCaptureWindowWithProfile<GameCubeProfile>( capture, checkpoints, start_sample, end_sample, sink );
+        break;
+    }
+}
+
+// the decoder runs on logic's channel data through the edge cache, on imported captures with or without
+// the cache and on edges pushed through the c interface, with every device profile
+template class GameCubeControllerDecoder<GameCubeControllerCachedChannel<AnalyzerChannelData>>;
+template void GameCubeControllerDecoder<GameCubeControllerCachedChannel<AnalyzerChannelData>>::DecodeNext<GameCubeProfile>();
+template void GameCubeControllerDecoder<GameCubeControllerCachedChannel<AnalyzerChannelData>>::DecodeNext<N64Profile>();
+template class GameCubeControllerDecoder<GameCubeControllerCachedChannel<GameCubeControllerCaptureChannel>>;
+template void GameCubeControllerDecoder<GameCubeControllerCachedChannel<GameCubeControllerCaptureChannel>>::DecodeNext<GameCubeProfile>();
+template void GameCubeControllerDecoder<GameCubeControllerCachedChannel<GameCubeControllerCaptureChannel>>::DecodeNext<N64Profile>();
+template class GameCubeControllerDecoder<GameCubeControllerCaptureChannel>;
+template void GameCubeControllerDecoder<GameCubeControllerCaptureChannel>::DecodeNext<GameCubeProfile>();
+template void GameCubeControllerDecoder<GameCubeControllerCaptureChannel>::DecodeNext<N64Profile>();
+template class GameCubeControllerDecoder<GameCubeControllerEdgeStream>;
+template void GameCubeControllerDecoder<GameCubeControllerEdgeStream>::DecodeNext<GameCubeProfile>();
+template void GameCubeControllerDecoder<GameCubeControllerEdgeStream>::DecodeNext<N64Profile>();
@@ -0,0 +1,129 @@
+#ifndef GAMECUBECONTROLLER_DECODER
+#define GAMECUBECONTROLLER_DECODER
+
+#include "GameCubeControllerCheckpoints.h"
+#include "GameCubeControllerCommands.h"
+
+#include <LogicPublicTypes.h>
+
+// bit timing limits. a bit's low time tells its value, and no low or high time within a packet lasts as
+// long as JOYBUS_MAX_PULSE_NS. the line idles at least JOYBUS_IDLE_NS between transactions, which is
+// also the longest a controller takes to respond
+static const U64 JOYBUS_ONE_BIT_NS = 2000;
+static const U64 JOYBUS_STOP_BIT_NS = 2500;
+static const U64 JOYBUS_MAX_PULSE_NS = 5000;
+static const U64 JOYBUS_IDLE_NS = 100000;
+
+// the number of samples a limit corresponds to, rounded up so a pulse is shorter than the limit exactly
+// when it is shorter in samples. even an hour's limit at the highest sample rates fits in 64 bits
+inline U64 JoyBusNsToSamples( U64 ns, U32 sample_rate_hz )
+{
+    return ( ns * sample_rate_hz + 999999999 ) / 1000000000;
+}
+
+// receives everything the decoder produces. the analyzer turns this into frames, offline tools can
+// consume it directly
+class GameCubeControllerDecoderSink
+{
+  public:
+    virtual ~GameCubeControllerDecoderSink()
+    {
+    }
+
+    // called for the middle of every decoded data bit
+    virtual void OnBit( U64 sample ) = 0;
+    // called for every packet whose command was transmitted completely. the controller state is already
+    // unpacked. info is nullptr for commands with an unknown layout
+    virtual void OnPacket( const JoyBusPacket& packet, const JoyBusCommandInfo* info, U64 start_sample, U64 end_sample ) = 0;
+    // called before the first packet when decoding starts partway through a capture, with the state
+    // left by the packets which were skipped
+    virtual void OnResume( const GameCubeControllerCheckpoint& )
+    {
+    }
+    // called for every packet dropped because its command was corrupted. the end of an imported capture
+    // isn't reported
+    virtual void OnDrop( U64 )
+    {
+    }
+};
+
+// the joybus bit and packet layer. Channel provides the subset of AnalyzerChannelData used here:
+// GetSampleNumber, GetBitState, AdvanceToNextEdge and GetSampleOfNextEdge, so the same decoder runs
+// inside logic and on imported captures
+template <class Channel>
+class GameCubeControllerDecoder
+{
+  public:
+    GameCubeControllerDecoder( Channel* channel, U32 sample_rate_hz, GameCubeControllerDecoderSink* sink );
+
+    // synchronizes to the first idle period of the capture. not needed when the channel was moved to a
+    // checkpoint, which is already between packets
+    void Start();
+
+    // records a checkpoint every so many packets while decoding
+    void SetCheckpoints( GameCubeControllerCheckpoints* checkpoints );
+
+    // the poll mode and origin left by the packets decoded so far. set from a checkpoint when decoding
+    // resumes there
+    const GameCubeControllerCheckpoint& GetProtocolState() const;
+    void SetProtocolState( const GameCubeControllerCheckpoint& state );
+
+    // decodes the next packet, reporting it to the sink. corrupted packets are dropped and the decoder
+    // resynchronizes on the following idle period
+    template <class Profile>
+    void DecodeNext();
+
+  protected:
+    static U64 GetPulseWidth( U64 start_edge, U64 end_edge );
+    void AdvanceToEndOfPacket();
+    bool AdvanceToNextBitInPacket();
+    bool DecodePacket( const JoyBusCommandInfo& info, JoyBusPacket& packet, bool& transmitted );
+    bool DecodeUnknownPacket( JoyBusPacket& packet, bool& transmitted );
+    bool DecodeRawBits( U32& count );
+    bool IsRawStopBit( U32 index );
+    void PackRawBits( U32 first, U32 count, U8* bytes );
+    bool DecodeByte( U8& byte );
+    bool DecodeDataBit( bool& bit );
+    bool DecodeStopBit();
+
+    Channel* mGamecube;
+    U32 mSampleRateHz;
+    GameCubeControllerDecoderSink* mSink;
+
+    // the JOYBUS_ limits in samples. pulses are only ever compared in samples, so there is no division
+    // per edge and idle periods of any length compare correctly
+    U64 mOneBitSamples;
+    U64 mStopBitSamples;
+    U64 mMaxPulseSamples;
+    U64 mIdleSamples;
+    GameCubeControllerCheckpoints* mCheckpoints;
+    GameCubeControllerCheckpoint mProtocolState;
+
+    bool mDecodedTransmission;
+    bool mDecodedReception;
+
+    // where the command ended and the response started in the packet being decoded. 0 if not reached
+    U64 mCommandEndSample;
+    U64 mResponseStartSample;
+
+    // raw bits of a transaction with an unknown layout. a host transfer and a response may each carry
+    // up to JOYBUS_MAX_TRANSFER_BYTES bytes plus a stop bit
+    static const U32 MAX_RAW_BITS = 2 * ( JOYBUS_MAX_TRANSFER_BYTES * 8 + 1 );
+    U64 mRawBitFallingEdges[ MAX_RAW_BITS + 1 ];
+    U64 mRawBitRisingEdges[ MAX_RAW_BITS ];
+};
+
+class GameCubeControllerCapture;
+
+// decodes an imported capture from start to end. if checkpoints is given, it should be freshly reset and
+// is filled in along the way
+void DecodeCapture( GameCubeControllerCapture& capture, JoyBusDevice device, GameCubeControllerDecoderSink& sink,
+                    GameCubeControllerCheckpoints* checkpoints = nullptr );
+
+// decodes only the packets starting within [ start_sample, end_sample ). decoding starts from the last
+// checkpoint before the window, so the cost depends on the window and the checkpoint interval rather
+// than on where the window is in the capture
+void DecodeCaptureWindow( GameCubeControllerCapture& capture, JoyBusDevice device, const GameCubeControllerCheckpoints& checkpoints,
+                          U64 start_sample, U64 end_sample, GameCubeControllerDecoderSink& sink );
+
+#endif // GAMECUBECONTROLLER_DECODER
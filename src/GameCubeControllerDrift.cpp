@@ -0,0 +1,130 @@
+#include "GameCubeControllerDrift.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+const char* const GAMECUBE_DRIFT_EVENT_NAMES[ DRIFT_EVENT_COUNT ] = { "Drift", "Recovered", "Origin", "Recalibrate" };
+
+// the error and origin bits aren't inputs
+static const U16 INPUT_BUTTONS = 0x7F1F;
+
+GameCubeControllerDriftDetector::GameCubeControllerDriftDetector() : mThreshold( 12 ), mRestPolls( 0 ), mDrifting( 0 )
+{
+}
+
+void GameCubeControllerDriftDetector::Reset( U32 threshold )
+{
+    mThreshold = threshold;
+    mRestPolls = 0;
+    mDrifting = 0;
+}
+
+U32 GameCubeControllerDriftDetector::AddPacket( const JoyBusPacket& packet, GameCubeControllerDriftEvent* events )
+{
+    if( !packet.mHasState )
+    {
+        return 0;
+    }
+
+    const GameCubeControllerState& state = packet.mState;
+
+    // a new origin moves the reference every axis is measured against
+    if( packet.mCommand == CMD_ORIGIN || packet.mCommand == CMD_RECALIBRATE )
+    {
+        GameCubeControllerDriftEvent& event = events[ 0 ];
+        event.mType = packet.mCommand == CMD_ORIGIN ? DRIFT_ORIGIN : DRIFT_RECALIBRATE;
+        event.mAxis = AXIS_COUNT;
+        event.mOffset = 0;
+
+        if( packet.mHasOrigin )
+        {
+            U8 present = state.mAxesPresent & packet.mOrigin.mAxesPresent;
+            for( U32 i = 0; i < AXES; i++ )
+            {
+                S32 shift = state.mAxes[ i ] - packet.mOrigin.mAxes[ i ];
+                if( ( present & ( 1 << i ) ) && abs( shift ) > abs( event.mOffset ) )
+                {
+                    event.mAxis = i;
+                    event.mOffset = shift;
+                }
+            }
+        }
+
+        mRestPolls = 0;
+        return 1;
+    }
+
+    if( !packet.mHasOrigin )
+    {
+        return 0;
+    }
+
+    U8 present = state.mAxesPresent & packet.mOrigin.mAxesPresent;
+
+    bool at_rest = ( ( state.mButtons[ 0 ] | ( state.mButtons[ 1 ] << 8 ) ) & INPUT_BUTTONS ) == 0;
+    for( U32 i = 0; i < AXES && at_rest; i++ )
+    {
+        if( ( present & ( 1 << i ) ) && static_cast<U32>( abs( state.mAxes[ i ] - packet.mOrigin.mAxes[ i ] ) ) > MAX_OFFSET )
+        {
+            at_rest = false;
+        }
+    }
+    if( !at_rest )
+    {
+        mRestPolls = 0;
+        return 0;
+    }
+
+    // an axis leaving its band starts the rest over from this poll
+    for( U32 i = 0; i < AXES && mRestPolls != 0; i++ )
+    {
+        U8 low = state.mAxes[ i ] < mRestMin[ i ] ? state.mAxes[ i ] : mRestMin[ i ];
+        U8 high = state.mAxes[ i ] > mRestMax[ i ] ? state.mAxes[ i ] : mRestMax[ i ];
+        if( ( present & ( 1 << i ) ) && static_cast<U32>( high - low ) > STEADY_RANGE )
+        {
+            mRestPolls = 0;
+        }
+        mRestMin[ i ] = low;
+        mRestMax[ i ] = high;
+    }
+    if( mRestPolls == 0 )
+    {
+        std::copy( state.mAxes, state.mAxes + AXES, mRestMin );
+        std::copy( state.mAxes, state.mAxes + AXES, mRestMax );
+    }
+    mRestPolls++;
+
+    if( mRestPolls < REST_POLLS )
+    {
+        return 0;
+    }
+
+    U32 count = 0;
+    for( U32 i = 0; i < AXES; i++ )
+    {
+        if( !( present & ( 1 << i ) ) )
+        {
+            continue;
+        }
+
+        S32 offset = state.mAxes[ i ] - packet.mOrigin.mAxes[ i ];
+        U32 distance = abs( offset );
+        bool drifting = ( mDrifting & ( 1 << i ) ) != 0;
+
+        // half the threshold to recover, so an axis sitting right at the threshold doesn't flicker
+        if( !drifting && distance >= mThreshold )
+        {
+            GameCubeControllerDriftEvent event = { DRIFT_START, i, offset };
+            events[ count++ ] = event;
+            mDrifting |= 1 << i;
+        }
+        else if( drifting && distance < mThreshold / 2 )
+        {
+            GameCubeControllerDriftEvent event = { DRIFT_END, i, offset };
+            events[ count++ ] = event;
+            mDrifting &= ~( 1 << i );
+        }
+    }
+
+    return count;
+}
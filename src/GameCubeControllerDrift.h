@@ -0,0 +1,68 @@
+#ifndef GAMECUBECONTROLLER_DRIFT
+#define GAMECUBECONTROLLER_DRIFT
+
+#include "GameCubeControllerCommands.h"
+
+enum GameCubeControllerDriftEventType
+{
+    // an axis at rest settled at least the threshold away from the origin
+    DRIFT_START,
+    // a drifting axis came back to within half the threshold
+    DRIFT_END,
+    // the controller reported a new origin. the axis is the one which moved furthest from the previous
+    // origin, if there was one
+    DRIFT_ORIGIN,
+    DRIFT_RECALIBRATE,
+    DRIFT_EVENT_COUNT,
+};
+
+extern const char* const GAMECUBE_DRIFT_EVENT_NAMES[ DRIFT_EVENT_COUNT ];
+
+struct GameCubeControllerDriftEvent
+{
+    GameCubeControllerDriftEventType mType;
+    // AXIS_COUNT if the event isn't about an axis
+    U32 mAxis;
+    // the axis' offset from the origin, or for a new origin how far it moved
+    S32 mOffset;
+};
+
+// watches for sticks and triggers which don't return to the origin the controller reported. an axis is
+// only judged while the controller is at rest: no buttons held, every axis near the origin and steady
+// for several seconds, so holding a stick or trigger isn't mistaken for drift. everything is updated
+// per packet in constant time
+class GameCubeControllerDriftDetector
+{
+  public:
+    // the sticks and the analog triggers are watched. the analog a/b buttons are rarely reported
+    static const U32 AXES = AXIS_R + 1;
+    static const U32 MAX_EVENTS = AXES;
+
+    // an axis further than this from the origin is being held. worn sticks rarely drift by more than
+    // half of it, while deliberate deflection runs out to about 100
+    static const U32 MAX_OFFSET = 30;
+    // polls in a row with every axis staying within a STEADY_RANGE wide band, before the controller
+    // counts as at rest. about five seconds of polling once per video frame
+    static const U32 REST_POLLS = 300;
+    static const U32 STEADY_RANGE = 4;
+
+    GameCubeControllerDriftDetector();
+
+    void Reset( U32 threshold );
+
+    // returns how many events the packet caused, filling in up to MAX_EVENTS
+    U32 AddPacket( const JoyBusPacket& packet, GameCubeControllerDriftEvent* events );
+
+  protected:
+    U32 mThreshold;
+
+    // the polls at rest so far, and the band each axis stayed in over them
+    U32 mRestPolls;
+    U8 mRestMin[ AXES ];
+    U8 mRestMax[ AXES ];
+
+    // bit n is set while axis n is drifting
+    U32 mDrifting;
+};
+
+#endif // GAMECUBECONTROLLER_DRIFT
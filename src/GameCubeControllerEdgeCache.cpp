@@ -0,0 +1,239 @@
+#include "GameCubeControllerEdgeCache.h"
+
+#include "GameCubeControllerCapture.h"
+
+#include <AnalyzerChannelData.h>
+
+GameCubeControllerEdgeCache::GameCubeControllerEdgeCache()
+    : mSampleRateHz( 0 ),
+      mStarted( false ),
+      mFull( false ),
+      mFirstSample( 0 ),
+      mFirstBitState( BIT_HIGH ),
+      mLastSample( 0 ),
+      mEdgeCount( 0 )
+{
+}
+
+void GameCubeControllerEdgeCache::Prepare( const Channel& channel, U32 sample_rate_hz )
+{
+    if( mChannel != channel || mSampleRateHz != sample_rate_hz )
+    {
+        Clear();
+        mChannel = channel;
+        mSampleRateHz = sample_rate_hz;
+    }
+}
+
+void GameCubeControllerEdgeCache::Clear()
+{
+    mStarted = false;
+    mFull = false;
+    mEdgeCount = 0;
+    std::vector<U8>().swap( mDeltas );
+}
+
+void GameCubeControllerEdgeCache::Start( U64 sample, BitState bit_state )
+{
+    Clear();
+    mStarted = true;
+    mFirstSample = mLastSample = sample;
+    mFirstBitState = bit_state;
+}
+
+void GameCubeControllerEdgeCache::AddEdge( U64 sample )
+{
+    if( mFull )
+    {
+        return;
+    }
+    if( mDeltas.size() >= MAX_BYTES )
+    {
+        // the cache has to stay a contiguous prefix, so nothing is added once it's full
+        mFull = true;
+        return;
+    }
+
+    // 7 bits per byte, low bits first, with the top bit set on all but the last byte
+    U64 delta = sample - mLastSample;
+    while( delta >= 0x80 )
+    {
+        mDeltas.push_back( static_cast<U8>( delta | 0x80 ) );
+        delta >>= 7;
+    }
+    mDeltas.push_back( static_cast<U8>( delta ) );
+
+    mLastSample = sample;
+    mEdgeCount++;
+}
+
+void GameCubeControllerEdgeCache::Truncate( U64 edge_count, U64 size, U64 last_sample )
+{
+    mDeltas.resize( size );
+    mEdgeCount = edge_count;
+    mLastSample = last_sample;
+    mFull = false;
+}
+
+bool GameCubeControllerEdgeCache::IsEmpty() const
+{
+    return !mStarted;
+}
+
+U64 GameCubeControllerEdgeCache::GetFirstSample() const
+{
+    return mFirstSample;
+}
+
+BitState GameCubeControllerEdgeCache::GetFirstBitState() const
+{
+    return mFirstBitState;
+}
+
+U64 GameCubeControllerEdgeCache::GetEdgeCount() const
+{
+    return mEdgeCount;
+}
+
+U64 GameCubeControllerEdgeCache::ReadEdge( U64& offset, U64 previous_sample ) const
+{
+    U64 delta = 0;
+    for( U32 shift = 0;; shift += 7 )
+    {
+        U8 byte = mDeltas[ offset++ ];
+        delta |= static_cast<U64>( byte & 0x7F ) << shift;
+        if( ( byte & 0x80 ) == 0 )
+        {
+            break;
+        }
+    }
+
+    return previous_sample + delta;
+}
+
+// logic's channel data only moves forward, while an imported capture seeks
+static void MoveTo( AnalyzerChannelData* channel, U64 sample )
+{
+    channel->AdvanceToAbsPosition( sample );
+}
+
+static void MoveTo( GameCubeControllerCaptureChannel* channel, U64 sample )
+{
+    channel->Seek( sample );
+}
+
+template <class LiveChannel>
+GameCubeControllerCachedChannel<LiveChannel>::GameCubeControllerCachedChannel( LiveChannel* channel, GameCubeControllerEdgeCache* cache )
+    : mChannel( channel ),
+      mCache( cache ),
+      mLive( false ),
+      mSample( 0 ),
+      mBitState( BIT_HIGH ),
+      mNextEdge( 0 ),
+      mNextSample( 0 ),
+      mNextOffset( 0 ),
+      mOffset( 0 )
+{
+    // a cache which doesn't even start like the channel belongs to another capture
+    if( !mCache->IsEmpty() &&
+        ( mChannel->GetSampleNumber() != mCache->GetFirstSample() || mChannel->GetBitState() != mCache->GetFirstBitState() ) )
+    {
+        mCache->Clear();
+    }
+
+    if( mCache->IsEmpty() )
+    {
+        mCache->Start( mChannel->GetSampleNumber(), mChannel->GetBitState() );
+        mLive = true;
+        return;
+    }
+
+    mSample = mCache->GetFirstSample();
+    mBitState = mCache->GetFirstBitState();
+    if( mCache->GetEdgeCount() > 0 )
+    {
+        mNextSample = mCache->ReadEdge( mOffset, mSample );
+    }
+}
+
+template <class LiveChannel>
+U64 GameCubeControllerCachedChannel<LiveChannel>::GetSampleNumber()
+{
+    return mLive ? mChannel->GetSampleNumber() : mSample;
+}
+
+template <class LiveChannel>
+BitState GameCubeControllerCachedChannel<LiveChannel>::GetBitState()
+{
+    return mLive ? mChannel->GetBitState() : mBitState;
+}
+
+template <class LiveChannel>
+void GameCubeControllerCachedChannel<LiveChannel>::AdvanceToNextEdge()
+{
+    if( !mLive )
+    {
+        if( mNextEdge < mCache->GetEdgeCount() )
+        {
+            // the channel is moved in step with the cache while verifying
+            if( mNextEdge < VERIFY_EDGES )
+            {
+                mChannel->AdvanceToNextEdge();
+                if( mChannel->GetSampleNumber() != mNextSample )
+                {
+                    mCache->Truncate( mNextEdge, mNextOffset, mSample );
+                    mCache->AddEdge( mChannel->GetSampleNumber() );
+                    mLive = true;
+                    return;
+                }
+            }
+
+            mSample = mNextSample;
+            mBitState = mBitState == BIT_HIGH ? BIT_LOW : BIT_HIGH;
+            mNextEdge++;
+            mNextOffset = mOffset;
+            if( mNextEdge < mCache->GetEdgeCount() )
+            {
+                mNextSample = mCache->ReadEdge( mOffset, mSample );
+            }
+            return;
+        }
+
+        GoLive();
+    }
+
+    mChannel->AdvanceToNextEdge();
+    mCache->AddEdge( mChannel->GetSampleNumber() );
+}
+
+template <class LiveChannel>
+U64 GameCubeControllerCachedChannel<LiveChannel>::GetSampleOfNextEdge()
+{
+    if( !mLive )
+    {
+        if( mNextEdge < VERIFY_EDGES )
+        {
+            return mChannel->GetSampleOfNextEdge();
+        }
+        if( mNextEdge < mCache->GetEdgeCount() )
+        {
+            return mNextSample;
+        }
+
+        GoLive();
+    }
+
+    return mChannel->GetSampleOfNextEdge();
+}
+
+// continues from the channel once the cache runs out
+template <class LiveChannel>
+void GameCubeControllerCachedChannel<LiveChannel>::GoLive()
+{
+    MoveTo( mChannel, mSample );
+    mLive = true;
+}
+
+// logic's channel data in the analyzer, imported captures in the tests
+template class GameCubeControllerCachedChannel<AnalyzerChannelData>;
+template class GameCubeControllerCachedChannel<GameCubeControllerCaptureChannel>;
@@ -0,0 +1,84 @@
+#ifndef GAMECUBECONTROLLER_EDGE_CACHE
+#define GAMECUBECONTROLLER_EDGE_CACHE
+
+#include <LogicPublicTypes.h>
+#include <vector>
+
+class AnalyzerChannelData;
+
+// the edges of the data line seen by earlier runs. bit boundaries, pulse widths and packet spans all
+// follow from the edges, so a re-run after a settings change decodes from memory and only reads the
+// channel past the end of the cache. edges are stored as variable-length deltas, mostly a byte each
+class GameCubeControllerEdgeCache
+{
+  public:
+    // past this, edges are read from the channel without being cached
+    static const U64 MAX_BYTES = 256ull << 20;
+
+    GameCubeControllerEdgeCache();
+
+    // drops the cache unless it was recorded from the same channel at the same sample rate
+    void Prepare( const Channel& channel, U32 sample_rate_hz );
+
+    void Clear();
+    void Start( U64 sample, BitState bit_state );
+    void AddEdge( U64 sample );
+    // keeps the first edge_count edges, whose deltas take size bytes
+    void Truncate( U64 edge_count, U64 size, U64 last_sample );
+
+    bool IsEmpty() const;
+    U64 GetFirstSample() const;
+    BitState GetFirstBitState() const;
+    U64 GetEdgeCount() const;
+
+    // decodes the edge at offset, following the edge at previous_sample, and moves offset past it
+    U64 ReadEdge( U64& offset, U64 previous_sample ) const;
+
+  protected:
+    Channel mChannel;
+    U32 mSampleRateHz;
+
+    bool mStarted;
+    bool mFull;
+    U64 mFirstSample;
+    BitState mFirstBitState;
+    U64 mLastSample;
+    U64 mEdgeCount;
+    std::vector<U8> mDeltas;
+};
+
+// presents the cached edges followed by the live channel, with the subset of AnalyzerChannelData used by
+// the decoder. edges read from the channel are added to the cache. the first few cached edges are
+// checked against the channel, and if they differ the capture was replaced: the cache is cut off there
+// and decoding carries on from the channel. LiveChannel is logic's AnalyzerChannelData, or an imported
+// capture's GameCubeControllerCaptureChannel so the cache can be run outside of logic
+template <class LiveChannel>
+class GameCubeControllerCachedChannel
+{
+  public:
+    static const U64 VERIFY_EDGES = 1024;
+
+    GameCubeControllerCachedChannel( LiveChannel* channel, GameCubeControllerEdgeCache* cache );
+
+    U64 GetSampleNumber();
+    BitState GetBitState();
+    void AdvanceToNextEdge();
+    U64 GetSampleOfNextEdge();
+
+  protected:
+    void GoLive();
+
+    LiveChannel* mChannel;
+    GameCubeControllerEdgeCache* mCache;
+    bool mLive;
+
+    // the replay position. the next edge is decoded ahead of time
+    U64 mSample;
+    BitState mBitState;
+    U64 mNextEdge;
+    U64 mNextSample;
+    U64 mNextOffset;
+    U64 mOffset;
+};
+
+#endif // GAMECUBECONTROLLER_EDGE_CACHE
@@ -0,0 +1,115 @@
+#include "GameCubeControllerEdgeStream.h"
+
+#include "GameCubeControllerDecoder.h"
+
+GameCubeControllerEdgeStream::GameCubeControllerEdgeStream( U32 sample_rate_hz, BitState initial_bit_state )
+    : mSampleRateHz( sample_rate_hz ),
+      mIdleSamples( JoyBusNsToSamples( JOYBUS_IDLE_NS, sample_rate_hz ) ),
+      mNextEdge( 0 ),
+      mSample( 0 ),
+      mBitState( initial_bit_state ),
+      mHasEdges( false ),
+      mLastSample( 0 ),
+      mLastBitState( initial_bit_state ),
+      mSafeSample( 0 ),
+      mHasSafeSample( false ),
+      mFinished( false ),
+      mAtEnd( false )
+{
+}
+
+bool GameCubeControllerEdgeStream::Push( const U64* samples, size_t count )
+{
+    // the whole batch is checked first, so a bad batch leaves the stream as it was
+    U64 previous_sample = mLastSample;
+    for( size_t i = 0; i < count; i++ )
+    {
+        if( ( mHasEdges || i > 0 ) && samples[ i ] <= previous_sample )
+        {
+            return false;
+        }
+        previous_sample = samples[ i ];
+    }
+
+    for( size_t i = 0; i < count; i++ )
+    {
+        if( mLastBitState == BIT_HIGH && samples[ i ] - mLastSample >= mIdleSamples )
+        {
+            mSafeSample = mLastSample;
+            mHasSafeSample = true;
+        }
+
+        mEdges.push_back( samples[ i ] );
+        mHasEdges = true;
+        mLastSample = samples[ i ];
+        mLastBitState = mLastBitState == BIT_HIGH ? BIT_LOW : BIT_HIGH;
+    }
+
+    return true;
+}
+
+void GameCubeControllerEdgeStream::Finish()
+{
+    mFinished = true;
+}
+
+bool GameCubeControllerEdgeStream::IsDecodable()
+{
+    if( mFinished )
+    {
+        return !mAtEnd;
+    }
+
+    return mHasSafeSample && mSample < mSafeSample;
+}
+
+void GameCubeControllerEdgeStream::Compact()
+{
+    // erasing shifts the remaining edges, so only do it once most of the buffer is spent
+    if( mNextEdge > mEdges.size() / 2 )
+    {
+        mEdges.erase( mEdges.begin(), mEdges.begin() + mNextEdge );
+        mNextEdge = 0;
+    }
+}
+
+U64 GameCubeControllerEdgeStream::GetSampleNumber()
+{
+    return mSample;
+}
+
+BitState GameCubeControllerEdgeStream::GetBitState()
+{
+    return mBitState;
+}
+
+void GameCubeControllerEdgeStream::AdvanceToNextEdge()
+{
+    mSample = GetSampleOfNextEdge();
+    mBitState = mBitState == BIT_HIGH ? BIT_LOW : BIT_HIGH;
+
+    if( mNextEdge < mEdges.size() )
+    {
+        mNextEdge++;
+    }
+    else
+    {
+        mAtEnd = true;
+    }
+}
+
+// past the last edge the line is idle, for a second at a time like an imported capture
+U64 GameCubeControllerEdgeStream::GetSampleOfNextEdge()
+{
+    if( mNextEdge < mEdges.size() )
+    {
+        return mEdges[ mNextEdge ];
+    }
+
+    return mSample + mSampleRateHz;
+}
+
+bool GameCubeControllerEdgeStream::IsAtEnd()
+{
+    return mAtEnd;
+}
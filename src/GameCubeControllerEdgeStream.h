@@ -0,0 +1,55 @@
+#ifndef GAMECUBECONTROLLER_EDGE_STREAM
+#define GAMECUBECONTROLLER_EDGE_STREAM
+
+#include <LogicPublicTypes.h>
+#include <vector>
+
+// edges handed over in batches by the caller, presented with the subset of AnalyzerChannelData used by
+// the decoder. a packet never spans 100us of idle line, so everything before the last such gap is
+// complete and can be decoded while later edges are still to come
+class GameCubeControllerEdgeStream
+{
+  public:
+    GameCubeControllerEdgeStream( U32 sample_rate_hz, BitState initial_bit_state );
+
+    // appends edges, which must come after every edge pushed so far. returns false otherwise
+    bool Push( const U64* samples, size_t count );
+    // no more edges will come. the line stays idle after the last one
+    void Finish();
+
+    // true while the decoder may start another packet
+    bool IsDecodable();
+    // forgets the edges the decoder has passed
+    void Compact();
+
+    U64 GetSampleNumber();
+    BitState GetBitState();
+    void AdvanceToNextEdge();
+    U64 GetSampleOfNextEdge();
+
+    bool IsAtEnd();
+
+  protected:
+    U32 mSampleRateHz;
+    // the idle time the decoder resynchronizes on, which also ends every response window
+    U64 mIdleSamples;
+
+    std::vector<U64> mEdges;
+    size_t mNextEdge;
+    U64 mSample;
+    BitState mBitState;
+
+    // the last edge pushed, and the level after it
+    bool mHasEdges;
+    U64 mLastSample;
+    BitState mLastBitState;
+
+    // the rising edge starting the last idle gap
+    U64 mSafeSample;
+    bool mHasSafeSample;
+
+    bool mFinished;
+    bool mAtEnd;
+};
+
+#endif // GAMECUBECONTROLLER_EDGE_STREAM
@@ -0,0 +1,126 @@
+#include "GameCubeControllerEventIndex.h"
+
+#include <algorithm>
+
+GameCubeControllerEventIndex::GameCubeControllerEventIndex()
+    : mStickThreshold( 64 ), mTriggerThreshold( 128 ), mWindowSamples( 0 ), mHasState( false ), mLastActiveAxes( 0 )
+{
+}
+
+void GameCubeControllerEventIndex::Reset( U8 stick_threshold, U8 trigger_threshold, U64 window_samples )
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+
+    mStickThreshold = stick_threshold;
+    mTriggerThreshold = trigger_threshold;
+    mWindowSamples = window_samples;
+    mHasState = false;
+    mLastActiveAxes = 0;
+
+    for( U32 i = 0; i < INPUT_COUNT; i++ )
+    {
+        mEvents[ i ][ 0 ].clear();
+        mEvents[ i ][ 1 ].clear();
+    }
+}
+
+bool GameCubeControllerEventIndex::IsAxisActive( U32 axis, U8 value ) const
+{
+    if( axis <= AXIS_C_STICK_Y )
+    {
+        int deflection = value - 128;
+        return deflection >= mStickThreshold || -deflection >= mStickThreshold;
+    }
+
+    return value >= mTriggerThreshold;
+}
+
+void GameCubeControllerEventIndex::AddState( U64 sample, const GameCubeControllerState& state )
+{
+    U32 buttons = state.mButtons[ 0 ] | ( state.mButtons[ 1 ] << 8 );
+
+    // axes the poll mode didn't report keep their last value
+    U32 active_axes = mLastActiveAxes;
+    for( U32 i = 0; i < AXIS_COUNT; i++ )
+    {
+        if( state.mAxesPresent & ( 1 << i ) )
+        {
+            active_axes = IsAxisActive( i, state.mAxes[ i ] ) ? active_axes | ( 1 << i ) : active_axes & ~( 1 << i );
+        }
+    }
+
+    U32 inputs = buttons | ( active_axes << BUTTON_COUNT );
+
+    if( !mHasState )
+    {
+        // the first state is the baseline, nothing has changed yet
+        mHasState = true;
+    }
+    else
+    {
+        U32 last_inputs = mLastState.mButtons[ 0 ] | ( mLastState.mButtons[ 1 ] << 8 ) | ( mLastActiveAxes << BUTTON_COUNT );
+        U32 changed = inputs ^ last_inputs;
+
+        // nearly every poll is identical to the last, so only take the lock when something changed
+        if( changed != 0 )
+        {
+            std::lock_guard<std::mutex> lock( mMutex );
+            for( U32 i = 0; i < INPUT_COUNT; i++ )
+            {
+                if( changed & ( 1 << i ) )
+                {
+                    std::deque<U64>& events = mEvents[ i ][ ( inputs & ( 1 << i ) ) ? 0 : 1 ];
+                    events.push_back( sample );
+
+                    while( mWindowSamples != 0 && sample - events.front() > mWindowSamples )
+                    {
+                        events.pop_front();
+                    }
+                }
+            }
+        }
+    }
+
+    mLastState = state;
+    mLastActiveAxes = active_axes;
+}
+
+const char* GameCubeControllerEventIndex::GetInputName( U32 input )
+{
+    return input < BUTTON_COUNT ? GAMECUBE_BUTTON_NAMES[ input ] : GAMECUBE_AXIS_NAMES[ input - BUTTON_COUNT ];
+}
+
+bool GameCubeControllerEventIndex::FindNext( U32 input, bool active, U64 sample, U64& event_sample )
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+
+    const std::deque<U64>& events = mEvents[ input ][ active ? 0 : 1 ];
+    std::deque<U64>::const_iterator it = std::lower_bound( events.begin(), events.end(), sample );
+    if( it == events.end() )
+    {
+        return false;
+    }
+
+    event_sample = *it;
+    return true;
+}
+
+U64 GameCubeControllerEventIndex::Count( U32 input, bool active, U64 start_sample, U64 end_sample )
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+
+    const std::deque<U64>& events = mEvents[ input ][ active ? 0 : 1 ];
+    if( end_sample <= start_sample )
+    {
+        return 0;
+    }
+    return std::lower_bound( events.begin(), events.end(), end_sample ) - std::lower_bound( events.begin(), events.end(), start_sample );
+}
+
+void GameCubeControllerEventIndex::GetEvents( U32 input, bool active, std::vector<U64>& samples )
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+
+    const std::deque<U64>& events = mEvents[ input ][ active ? 0 : 1 ];
+    samples.assign( events.begin(), events.end() );
+}
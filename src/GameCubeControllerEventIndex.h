@@ -0,0 +1,55 @@
+#ifndef GAMECUBECONTROLLER_EVENT_INDEX
+#define GAMECUBECONTROLLER_EVENT_INDEX
+
+#include "GameCubeControllerState.h"
+
+#include <deque>
+#include <mutex>
+#include <vector>
+
+// records the sample of every button press/release and every analog threshold crossing, so input
+// events can be found with a binary search instead of scanning every status frame. inputs are
+// numbered with the buttons first, followed by the axes
+class GameCubeControllerEventIndex
+{
+  public:
+    static const U32 INPUT_COUNT = BUTTON_COUNT + AXIS_COUNT;
+
+    GameCubeControllerEventIndex();
+
+    // an axis is active when a stick is deflected at least stick_threshold from center, or when a
+    // trigger or analog button is at least trigger_threshold. with a window, only events within that
+    // many samples of the newest are kept
+    void Reset( U8 stick_threshold, U8 trigger_threshold, U64 window_samples );
+    void AddState( U64 sample, const GameCubeControllerState& state );
+
+    static const char* GetInputName( U32 input );
+
+    // finds the first time an input became active (or inactive) at or after sample. returns false if
+    // there is no such event
+    bool FindNext( U32 input, bool active, U64 sample, U64& event_sample );
+    // counts the times an input became active (or inactive) in [ start_sample, end_sample )
+    U64 Count( U32 input, bool active, U64 start_sample, U64 end_sample );
+    // copies the sorted samples of every time an input became active (or inactive)
+    void GetEvents( U32 input, bool active, std::vector<U64>& samples );
+
+  protected:
+    bool IsAxisActive( U32 axis, U8 value ) const;
+
+    U8 mStickThreshold;
+    U8 mTriggerThreshold;
+    U64 mWindowSamples;
+
+    bool mHasState;
+    GameCubeControllerState mLastState;
+    U32 mLastActiveAxes;
+
+    // [ input ][ 0 ] holds the samples where the input became active, [ input ][ 1 ] where it became
+    // inactive. appended in decode order, so they are always sorted
+    std::deque<U64> mEvents[ INPUT_COUNT ][ 2 ];
+
+    // the index is filled by the worker thread while results are being read
+    std::mutex mMutex;
+};
+
+#endif // GAMECUBECONTROLLER_EVENT_INDEX
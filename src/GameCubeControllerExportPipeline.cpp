@@ -0,0 +1,113 @@
+#include "GameCubeControllerExportPipeline.h"
+
+#include "GameCubeControllerExportWriter.h"
+
+#include <algorithm>
+
+GameCubeControllerExportPipeline::GameCubeControllerExportPipeline( AnalyzerResults* results, const FormatFunction& format )
+    : mResults( results ), mFormat( format ), mStopping( false )
+{
+    U32 threads = std::max( std::thread::hardware_concurrency(), 1u );
+    for( U32 i = 0; i < threads; i++ )
+    {
+        mWorkers.push_back( std::thread( &GameCubeControllerExportPipeline::WorkerThread, this ) );
+    }
+}
+
+GameCubeControllerExportPipeline::~GameCubeControllerExportPipeline()
+{
+    {
+        std::lock_guard<std::mutex> lock( mMutex );
+        mStopping = true;
+    }
+    mQueued.notify_all();
+
+    for( size_t i = 0; i < mWorkers.size(); i++ )
+    {
+        mWorkers[ i ].join();
+    }
+}
+
+bool GameCubeControllerExportPipeline::Run( U64 num_frames, GameCubeControllerExportWriter& writer )
+{
+    // two chunks per worker keeps every worker busy while the oldest chunk is being written
+    std::vector<Chunk> chunks( mWorkers.size() * 2 );
+    U64 num_chunks = ( num_frames + CHUNK_FRAMES - 1 ) / CHUNK_FRAMES;
+    U64 next_queued = 0;
+    U64 next_written = 0;
+    bool cancelled = false;
+
+    while( next_written < next_queued || ( !cancelled && next_queued < num_chunks ) )
+    {
+        while( !cancelled && next_queued < num_chunks && next_queued - next_written < chunks.size() )
+        {
+            Chunk& chunk = chunks[ next_queued % chunks.size() ];
+            chunk.mFirstFrame = next_queued * CHUNK_FRAMES;
+            chunk.mFrames.clear();
+            chunk.mText.clear();
+            chunk.mFormatted = false;
+
+            U64 end_frame = std::min( chunk.mFirstFrame + CHUNK_FRAMES, num_frames );
+            for( U64 i = chunk.mFirstFrame; i < end_frame; i++ )
+            {
+                chunk.mFrames.push_back( mResults->GetFrame( i ) );
+            }
+
+            {
+                std::lock_guard<std::mutex> lock( mMutex );
+                mQueue.push_back( &chunk );
+            }
+            mQueued.notify_one();
+            next_queued++;
+        }
+
+        Chunk& chunk = chunks[ next_written % chunks.size() ];
+        {
+            std::unique_lock<std::mutex> lock( mMutex );
+            while( !chunk.mFormatted )
+            {
+                mFormatted.wait( lock );
+            }
+        }
+        next_written++;
+
+        // after a cancel, the chunks already queued are only waited for
+        if( !cancelled )
+        {
+            writer.Write( chunk.mText );
+            cancelled = mResults->UpdateExportProgressAndCheckForCancel( chunk.mFirstFrame + chunk.mFrames.size(), num_frames );
+        }
+    }
+
+    return !cancelled;
+}
+
+void GameCubeControllerExportPipeline::WorkerThread()
+{
+    for( ;; )
+    {
+        Chunk* chunk;
+        {
+            std::unique_lock<std::mutex> lock( mMutex );
+            while( mQueue.empty() && !mStopping )
+            {
+                mQueued.wait( lock );
+            }
+            if( mQueue.empty() )
+            {
+                return;
+            }
+
+            chunk = mQueue.front();
+            mQueue.pop_front();
+        }
+
+        mFormat( *chunk );
+
+        {
+            std::lock_guard<std::mutex> lock( mMutex );
+            chunk->mFormatted = true;
+        }
+        mFormatted.notify_all();
+    }
+}
@@ -0,0 +1,54 @@
+#ifndef GAMECUBECONTROLLER_EXPORT_PIPELINE
+#define GAMECUBECONTROLLER_EXPORT_PIPELINE
+
+#include <AnalyzerResults.h>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class GameCubeControllerExportWriter;
+
+// formats a per-frame export on every core. frames are read in chunks on the calling thread, each
+// chunk is formatted into its own buffer by a pool of workers, and the buffers are written in order by
+// the calling thread, which also reports progress and checks for cancellation
+class GameCubeControllerExportPipeline
+{
+  public:
+    static const U32 CHUNK_FRAMES = 4096;
+
+    struct Chunk
+    {
+        U64 mFirstFrame;
+        std::vector<Frame> mFrames;
+        std::string mText;
+        bool mFormatted;
+    };
+
+    // called on a worker thread to append the text of every frame in the chunk to mText
+    typedef std::function<void( Chunk& chunk )> FormatFunction;
+
+    GameCubeControllerExportPipeline( AnalyzerResults* results, const FormatFunction& format );
+    ~GameCubeControllerExportPipeline();
+
+    // exports frames [ 0, num_frames ). returns false if the export was cancelled
+    bool Run( U64 num_frames, GameCubeControllerExportWriter& writer );
+
+  protected:
+    void WorkerThread();
+
+    AnalyzerResults* mResults;
+    FormatFunction mFormat;
+
+    std::vector<std::thread> mWorkers;
+    std::mutex mMutex;
+    std::condition_variable mQueued;
+    std::condition_variable mFormatted;
+    std::deque<Chunk*> mQueue;
+    bool mStopping;
+};
+
+#endif // GAMECUBECONTROLLER_EXPORT_PIPELINE
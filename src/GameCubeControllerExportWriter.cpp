@@ -0,0 +1,105 @@
+#include "GameCubeControllerExportWriter.h"
+
+#include <cstring>
+
+GameCubeControllerExportWriter::GameCubeControllerExportWriter( const char* file, bool binary )
+    : mStream( file, binary ? std::ios::out | std::ios::binary : std::ios::out )
+{
+    mBuffer.reserve( BUFFER_SIZE );
+}
+
+GameCubeControllerExportWriter::~GameCubeControllerExportWriter()
+{
+    Close();
+}
+
+void GameCubeControllerExportWriter::Write( const void* data, U32 size )
+{
+    if( mBuffer.size() + size > BUFFER_SIZE )
+    {
+        Flush();
+    }
+
+    // anything that doesn't fit in an empty buffer goes straight to the file
+    if( size > BUFFER_SIZE )
+    {
+        mStream.write( static_cast<const char*>( data ), size );
+        return;
+    }
+
+    const char* bytes = static_cast<const char*>( data );
+    mBuffer.insert( mBuffer.end(), bytes, bytes + size );
+}
+
+void GameCubeControllerExportWriter::Write( const char* text )
+{
+    Write( text, static_cast<U32>( strlen( text ) ) );
+}
+
+void GameCubeControllerExportWriter::Write( const std::string& text )
+{
+    Write( text.data(), static_cast<U32>( text.size() ) );
+}
+
+void GameCubeControllerExportWriter::WriteNumber( S64 number )
+{
+    char digits[ 24 ];
+    U32 length = 0;
+
+    U64 magnitude = number < 0 ? 0 - static_cast<U64>( number ) : number;
+    do
+    {
+        digits[ sizeof( digits ) - 1 - length++ ] = '0' + magnitude % 10;
+        magnitude /= 10;
+    } while( magnitude != 0 );
+
+    if( number < 0 )
+    {
+        digits[ sizeof( digits ) - 1 - length++ ] = '-';
+    }
+
+    Write( digits + sizeof( digits ) - length, length );
+}
+
+void GameCubeControllerExportWriter::WriteLittleEndian( U64 value, U32 size )
+{
+    U8 bytes[ 8 ];
+    for( U32 i = 0; i < size; i++ )
+    {
+        bytes[ i ] = static_cast<U8>( value >> ( i * 8 ) );
+    }
+    Write( bytes, size );
+}
+
+void GameCubeControllerExportWriter::Patch( U64 offset, const void* data, U32 size )
+{
+    Flush();
+
+    std::streampos end = mStream.tellp();
+    mStream.seekp( offset );
+    mStream.write( static_cast<const char*>( data ), size );
+    mStream.seekp( end );
+}
+
+bool GameCubeControllerExportWriter::IsOpen() const
+{
+    return mStream.is_open();
+}
+
+void GameCubeControllerExportWriter::Flush()
+{
+    if( !mBuffer.empty() )
+    {
+        mStream.write( mBuffer.data(), mBuffer.size() );
+        mBuffer.clear();
+    }
+}
+
+void GameCubeControllerExportWriter::Close()
+{
+    if( mStream.is_open() )
+    {
+        Flush();
+        mStream.close();
+    }
+}
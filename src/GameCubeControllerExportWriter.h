@@ -0,0 +1,37 @@
+#ifndef GAMECUBECONTROLLER_EXPORT_WRITER
+#define GAMECUBECONTROLLER_EXPORT_WRITER
+
+#include <LogicPublicTypes.h>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// collects output in a fixed-size buffer and hands it to the file in large blocks. exports that emit
+// millions of short rows spend most of their time in per-call stream overhead otherwise
+class GameCubeControllerExportWriter
+{
+  public:
+    explicit GameCubeControllerExportWriter( const char* file, bool binary = false );
+    ~GameCubeControllerExportWriter();
+
+    void Write( const void* data, U32 size );
+    void Write( const char* text );
+    void Write( const std::string& text );
+    void WriteNumber( S64 number );
+    // writes the low size bytes of value, least significant first
+    void WriteLittleEndian( U64 value, U32 size );
+    // overwrites bytes that were already written, such as a header whose counts are only known at the end
+    void Patch( U64 offset, const void* data, U32 size );
+
+    bool IsOpen() const;
+    void Flush();
+    void Close();
+
+  protected:
+    static const U32 BUFFER_SIZE = 1 << 16;
+
+    std::ofstream mStream;
+    std::vector<char> mBuffer;
+};
+
+#endif // GAMECUBECONTROLLER_EXPORT_WRITER
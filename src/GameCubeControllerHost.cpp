@@ -0,0 +1,149 @@
+#include "GameCubeControllerHost.h"
+
+#include <algorithm>
+
+const char* const GAMECUBE_HOST_TYPE_NAMES[ HOST_TYPE_COUNT ] = { "Unknown", "Console", "USB Adapter", "Overclocked Adapter" };
+
+namespace
+{
+    // the ranges each kind of host was measured in. the first one matching both the bit period and the
+    // poll rate wins
+    struct HostRule
+    {
+        GameCubeControllerHostType mType;
+        double mMinBitUs;
+        double mMaxBitUs;
+        double mMinPollHz;
+        double mMaxPollHz;
+    };
+
+    const HostRule HOST_RULES[] = {
+        { HOST_CONSOLE, 4.5, 5.5, 25.0, 250.0 },
+        { HOST_ADAPTER, 3.5, 4.5, 100.0, 160.0 },
+        { HOST_OVERCLOCKED_ADAPTER, 3.5, 4.5, 160.0, 2000.0 },
+    };
+}
+
+GameCubeControllerHostClassifier::GameCubeControllerHostClassifier()
+    : mSampleRateHz( 0 ), mWindowSamples( 0 ), mDone( false ), mFirstPollSample( 0 ), mLastPollSample( 0 ), mBitPeriodSum( 0.0 ),
+      mCommands( 0 )
+{
+    Reset( 0 );
+}
+
+void GameCubeControllerHostClassifier::Reset( U32 sample_rate_hz )
+{
+    mSampleRateHz = sample_rate_hz;
+    mWindowSamples = static_cast<U64>( HOST_WINDOW_S * sample_rate_hz );
+    mDone = false;
+    mFirstPollSample = mLastPollSample = 0;
+    mBitPeriodSum = 0.0;
+    mCommands = 0;
+    std::fill( mPollModes, mPollModes + POLL_MODE_COUNT, 0 );
+
+    mProfile = GameCubeControllerHostProfile();
+    mProfile.mType = HOST_UNKNOWN;
+    mProfile.mPollMode = POLL_MODE_COUNT;
+}
+
+bool GameCubeControllerHostClassifier::AddPacket( const JoyBusPacket& packet, U64 start_sample )
+{
+    if( mDone )
+    {
+        return false;
+    }
+
+    // the command ends on the rising edge of its stop bit, whose low time is about a quarter of a bit
+    if( packet.mCommandEndSample > start_sample )
+    {
+        U32 bits = ( 1 + packet.mArgLength ) * 8;
+        mBitPeriodSum += ( packet.mCommandEndSample - start_sample ) / ( bits + 0.25 );
+        mCommands++;
+    }
+
+    bool poll = packet.mCommand == CMD_STATUS || packet.mCommand == CMD_STATUS_LONG || packet.mCommand == CMD_N64_STATUS;
+    if( !poll )
+    {
+        return false;
+    }
+
+    if( packet.mCommand != CMD_N64_STATUS && packet.mArgLength >= 1 )
+    {
+        mPollModes[ packet.mArgs[ 0 ] % POLL_MODE_COUNT ]++;
+    }
+
+    if( mProfile.mPolls == 0 )
+    {
+        mFirstPollSample = start_sample;
+    }
+    else
+    {
+        mIntervals[ mProfile.mPolls - 1 ] = start_sample - mLastPollSample;
+    }
+    mLastPollSample = start_sample;
+    mProfile.mPolls++;
+
+    bool window_done = mProfile.mPolls >= MIN_POLLS && start_sample - mFirstPollSample >= mWindowSamples;
+    if( window_done || mProfile.mPolls > MAX_POLLS )
+    {
+        Classify();
+        return true;
+    }
+
+    return false;
+}
+
+bool GameCubeControllerHostClassifier::Finish()
+{
+    if( !mDone && mProfile.mPolls >= 2 )
+    {
+        Classify();
+    }
+    return mDone;
+}
+
+bool GameCubeControllerHostClassifier::IsDone() const
+{
+    return mDone;
+}
+
+const GameCubeControllerHostProfile& GameCubeControllerHostClassifier::GetProfile() const
+{
+    return mProfile;
+}
+
+void GameCubeControllerHostClassifier::Classify()
+{
+    mDone = true;
+
+    U32 count = mProfile.mPolls - 1;
+    std::nth_element( mIntervals, mIntervals + count / 2, mIntervals + count );
+    mProfile.mPollInterval = mIntervals[ count / 2 ];
+    mProfile.mMinPollInterval = *std::min_element( mIntervals, mIntervals + count );
+    mProfile.mMaxPollInterval = *std::max_element( mIntervals, mIntervals + count );
+    mProfile.mBitPeriod = mCommands != 0 ? mBitPeriodSum / mCommands : 0.0;
+
+    U32 most_used = 0;
+    for( U32 i = 1; i < POLL_MODE_COUNT; i++ )
+    {
+        if( mPollModes[ i ] > mPollModes[ most_used ] )
+            most_used = i;
+    }
+    mProfile.mPollMode = mPollModes[ most_used ] != 0 ? most_used : POLL_MODE_COUNT;
+
+    if( mProfile.mPollInterval == 0 || mSampleRateHz == 0 )
+    {
+        return;
+    }
+
+    double bit_us = mProfile.mBitPeriod * 1e6 / mSampleRateHz;
+    double poll_hz = static_cast<double>( mSampleRateHz ) / mProfile.mPollInterval;
+    for( const HostRule& rule : HOST_RULES )
+    {
+        if( bit_us >= rule.mMinBitUs && bit_us < rule.mMaxBitUs && poll_hz >= rule.mMinPollHz && poll_hz < rule.mMaxPollHz )
+        {
+            mProfile.mType = rule.mType;
+            return;
+        }
+    }
+}
@@ -0,0 +1,82 @@
+#ifndef GAMECUBECONTROLLER_HOST
+#define GAMECUBECONTROLLER_HOST
+
+#include "GameCubeControllerCommands.h"
+
+enum GameCubeControllerHostType
+{
+    HOST_UNKNOWN,
+    // consoles drive their bits at 200 kbps and poll once or twice per video frame. the wii's gamecube
+    // ports time their polls the same way, so the two can't be told apart on the line
+    HOST_CONSOLE,
+    // usb adapters drive 250 kbps bits, polling at the 125 Hz of their usb interval or faster once
+    // overclocked
+    HOST_ADAPTER,
+    HOST_OVERCLOCKED_ADAPTER,
+    HOST_TYPE_COUNT,
+};
+
+extern const char* const GAMECUBE_HOST_TYPE_NAMES[ HOST_TYPE_COUNT ];
+
+// the least traffic a fingerprint covers, unless it already has MAX_POLLS polls
+static const double HOST_WINDOW_S = 1.0;
+
+// the polling profile measured over the first polls of a capture
+struct GameCubeControllerHostProfile
+{
+    GameCubeControllerHostType mType;
+    U32 mPolls;
+    // the median time from the start of one poll to the start of the next, and the extremes. in samples
+    U64 mPollInterval;
+    U64 mMinPollInterval;
+    U64 mMaxPollInterval;
+    // the host's bit period in samples, averaged over every command. a bit reads as a 1 if its low
+    // time is below half of it
+    double mBitPeriod;
+    // the poll mode used most, or POLL_MODE_COUNT if no poll had one
+    U32 mPollMode;
+};
+
+// tells which kind of host drives the line from the cadence of its polls and the timing of its bits.
+// commands are measured until the fingerprint has seen enough polls, and then classified once.
+// everything is updated per packet in constant time
+class GameCubeControllerHostClassifier
+{
+  public:
+    // the fingerprint covers at least MIN_POLLS polls and HOST_WINDOW_S of traffic, or MAX_POLLS poll intervals
+    static const U32 MIN_POLLS = 16;
+    static const U32 MAX_POLLS = 256;
+
+    GameCubeControllerHostClassifier();
+
+    void Reset( U32 sample_rate_hz );
+
+    // returns true once, for the packet which completed the fingerprint
+    bool AddPacket( const JoyBusPacket& packet, U64 start_sample );
+    // classifies what was measured so far, e.g. at the end of a capture too short for a full
+    // fingerprint. returns false if there were too few polls to classify anything
+    bool Finish();
+
+    bool IsDone() const;
+    const GameCubeControllerHostProfile& GetProfile() const;
+
+  protected:
+    void Classify();
+
+    U32 mSampleRateHz;
+    U64 mWindowSamples;
+    bool mDone;
+
+    U64 mFirstPollSample;
+    U64 mLastPollSample;
+    // the intervals between the polls so far, for the median
+    U64 mIntervals[ MAX_POLLS ];
+
+    double mBitPeriodSum;
+    U32 mCommands;
+    U32 mPollModes[ POLL_MODE_COUNT ];
+
+    GameCubeControllerHostProfile mProfile;
+};
+
+#endif // GAMECUBECONTROLLER_HOST
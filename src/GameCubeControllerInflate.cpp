@@ -0,0 +1,320 @@
+#include "GameCubeControllerInflate.h"
+
+namespace
+{
+    // canonical huffman code, decoded one bit at a time by walking the code lengths
+    struct Huffman
+    {
+        U16 mCounts[ 16 ];
+        U16 mSymbols[ 288 ];
+    };
+
+    struct BitReader
+    {
+        const U8* mInput;
+        U64 mInputSize;
+        U64 mPosition;
+        U32 mBits;
+        U32 mBitCount;
+        bool mOverrun;
+
+        U32 Read( U32 count )
+        {
+            while( mBitCount < count )
+            {
+                if( mPosition >= mInputSize )
+                {
+                    mOverrun = true;
+                    return 0;
+                }
+                mBits |= static_cast<U32>( mInput[ mPosition++ ] ) << mBitCount;
+                mBitCount += 8;
+            }
+
+            U32 value = mBits & ( ( 1u << count ) - 1 );
+            mBits >>= count;
+            mBitCount -= count;
+            return value;
+        }
+    };
+
+    bool BuildHuffman( Huffman& huffman, const U8* lengths, U32 count )
+    {
+        for( U32 i = 0; i < 16; i++ )
+        {
+            huffman.mCounts[ i ] = 0;
+        }
+        for( U32 i = 0; i < count; i++ )
+        {
+            huffman.mCounts[ lengths[ i ] ]++;
+        }
+        huffman.mCounts[ 0 ] = 0;
+
+        // reject over-subscribed codes
+        int left = 1;
+        for( U32 i = 1; i < 16; i++ )
+        {
+            left = ( left << 1 ) - huffman.mCounts[ i ];
+            if( left < 0 )
+            {
+                return false;
+            }
+        }
+
+        U16 offsets[ 16 ];
+        offsets[ 1 ] = 0;
+        for( U32 i = 1; i < 15; i++ )
+        {
+            offsets[ i + 1 ] = offsets[ i ] + huffman.mCounts[ i ];
+        }
+        for( U32 i = 0; i < count; i++ )
+        {
+            if( lengths[ i ] != 0 )
+            {
+                huffman.mSymbols[ offsets[ lengths[ i ] ]++ ] = i;
+            }
+        }
+
+        return true;
+    }
+
+    int DecodeSymbol( BitReader& reader, const Huffman& huffman )
+    {
+        int code = 0;
+        int first = 0;
+        int index = 0;
+        for( U32 length = 1; length < 16; length++ )
+        {
+            code |= reader.Read( 1 );
+            int count = huffman.mCounts[ length ];
+            if( code - first < count )
+            {
+                return huffman.mSymbols[ index + code - first ];
+            }
+            index += count;
+            first = ( first + count ) << 1;
+            code <<= 1;
+        }
+
+        return -1;
+    }
+
+    const U16 LENGTH_BASE[ 29 ] = { 3,  4,  5,  6,  7,  8,  9,  10, 11,  13,  15,  17,  19,  23, 27,
+                                    31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+    const U8 LENGTH_EXTRA[ 29 ] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+    const U16 DISTANCE_BASE[ 30 ] = { 1,   2,   3,   4,   5,   7,    9,    13,   17,   25,   33,   49,   65,    97,    129,
+                                      193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+    const U8 DISTANCE_EXTRA[ 30 ] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+    bool InflateBlock( BitReader& reader, const Huffman& lengths, const Huffman& distances, U8* output, U64 output_size, U64& position )
+    {
+        while( true )
+        {
+            int symbol = DecodeSymbol( reader, lengths );
+            if( symbol < 0 || reader.mOverrun )
+            {
+                return false;
+            }
+
+            if( symbol < 256 )
+            {
+                if( position >= output_size )
+                {
+                    return false;
+                }
+                output[ position++ ] = static_cast<U8>( symbol );
+            }
+            else if( symbol == 256 )
+            {
+                return true;
+            }
+            else
+            {
+                symbol -= 257;
+                if( symbol >= 29 )
+                {
+                    return false;
+                }
+                U32 length = LENGTH_BASE[ symbol ] + reader.Read( LENGTH_EXTRA[ symbol ] );
+
+                int distance_symbol = DecodeSymbol( reader, distances );
+                if( distance_symbol < 0 || distance_symbol >= 30 )
+                {
+                    return false;
+                }
+                U32 distance = DISTANCE_BASE[ distance_symbol ] + reader.Read( DISTANCE_EXTRA[ distance_symbol ] );
+
+                if( distance > position || length > output_size - position )
+                {
+                    return false;
+                }
+                for( U32 i = 0; i < length; i++, position++ )
+                {
+                    output[ position ] = output[ position - distance ];
+                }
+            }
+        }
+    }
+
+    // the codes of fixed huffman blocks, built once on first use
+    struct FixedTables
+    {
+        Huffman mLengths;
+        Huffman mDistances;
+
+        FixedTables()
+        {
+            U8 lengths[ 288 ];
+            for( U32 i = 0; i < 288; i++ )
+            {
+                lengths[ i ] = i < 144 ? 8 : i < 256 ? 9 : i < 280 ? 7 : 8;
+            }
+            BuildHuffman( mLengths, lengths, 288 );
+
+            for( U32 i = 0; i < 30; i++ )
+            {
+                lengths[ i ] = 5;
+            }
+            BuildHuffman( mDistances, lengths, 30 );
+        }
+    };
+
+    bool ReadDynamicTables( BitReader& reader, Huffman& lengths, Huffman& distances )
+    {
+        static const U8 order[ 19 ] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+        U32 length_count = reader.Read( 5 ) + 257;
+        U32 distance_count = reader.Read( 5 ) + 1;
+        U32 code_count = reader.Read( 4 ) + 4;
+        if( length_count > 286 || distance_count > 30 )
+        {
+            return false;
+        }
+
+        U8 code_lengths[ 19 ] = {};
+        for( U32 i = 0; i < code_count; i++ )
+        {
+            code_lengths[ order[ i ] ] = reader.Read( 3 );
+        }
+
+        Huffman codes;
+        if( !BuildHuffman( codes, code_lengths, 19 ) )
+        {
+            return false;
+        }
+
+        U8 table_lengths[ 286 + 30 ];
+        U32 count = 0;
+        while( count < length_count + distance_count )
+        {
+            int symbol = DecodeSymbol( reader, codes );
+            if( symbol < 0 || reader.mOverrun )
+            {
+                return false;
+            }
+
+            if( symbol < 16 )
+            {
+                table_lengths[ count++ ] = symbol;
+                continue;
+            }
+
+            U8 value = 0;
+            U32 repeat;
+            if( symbol == 16 )
+            {
+                if( count == 0 )
+                {
+                    return false;
+                }
+                value = table_lengths[ count - 1 ];
+                repeat = 3 + reader.Read( 2 );
+            }
+            else if( symbol == 17 )
+            {
+                repeat = 3 + reader.Read( 3 );
+            }
+            else
+            {
+                repeat = 11 + reader.Read( 7 );
+            }
+
+            if( count + repeat > length_count + distance_count )
+            {
+                return false;
+            }
+            while( repeat-- > 0 )
+            {
+                table_lengths[ count++ ] = value;
+            }
+        }
+
+        return BuildHuffman( lengths, table_lengths, length_count ) && BuildHuffman( distances, table_lengths + length_count, distance_count );
+    }
+}
+
+bool GameCubeControllerInflate( const U8* input, U64 input_size, U8* output, U64 output_size )
+{
+    BitReader reader = { input, input_size, 0, 0, 0, false };
+    U64 position = 0;
+
+    bool last = false;
+    while( !last )
+    {
+        last = reader.Read( 1 ) != 0;
+        U32 type = reader.Read( 2 );
+
+        if( type == 0 )
+        {
+            // stored blocks start on a byte boundary
+            reader.mBits = 0;
+            reader.mBitCount = 0;
+            if( reader.mPosition + 4 > input_size )
+            {
+                return false;
+            }
+
+            const U8* header = input + reader.mPosition;
+            U32 length = header[ 0 ] | ( header[ 1 ] << 8 );
+            U32 complement = header[ 2 ] | ( header[ 3 ] << 8 );
+            reader.mPosition += 4;
+            if( length != ( ~complement & 0xFFFF ) || length > input_size - reader.mPosition || length > output_size - position )
+            {
+                return false;
+            }
+
+            for( U32 i = 0; i < length; i++ )
+            {
+                output[ position++ ] = input[ reader.mPosition++ ];
+            }
+        }
+        else if( type == 1 )
+        {
+            static const FixedTables fixed;
+            if( !InflateBlock( reader, fixed.mLengths, fixed.mDistances, output, output_size, position ) )
+            {
+                return false;
+            }
+        }
+        else if( type == 2 )
+        {
+            Huffman lengths;
+            Huffman distances;
+            if( !ReadDynamicTables( reader, lengths, distances ) || !InflateBlock( reader, lengths, distances, output, output_size, position ) )
+            {
+                return false;
+            }
+        }
+        else
+        {
+            return false;
+        }
+
+        if( reader.mOverrun )
+        {
+            return false;
+        }
+    }
+
+    return position == output_size;
+}
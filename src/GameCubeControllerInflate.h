@@ -0,0 +1,10 @@
+#ifndef GAMECUBECONTROLLER_INFLATE
+#define GAMECUBECONTROLLER_INFLATE
+
+#include <LogicPublicTypes.h>
+
+// decompresses a raw deflate stream (rfc 1951), as stored in zip archives. output must hold exactly
+// output_size bytes. returns false if the stream is corrupt or doesn't decompress to output_size bytes
+bool GameCubeControllerInflate( const U8* input, U64 input_size, U8* output, U64 output_size );
+
+#endif // GAMECUBECONTROLLER_INFLATE
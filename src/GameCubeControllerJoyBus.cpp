@@ -0,0 +1,224 @@
+#include "GameCubeControllerJoyBus.h"
+
+#include "GameCubeControllerDecoder.h"
+#include "GameCubeControllerEdgeStream.h"
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <vector>
+
+static_assert( JOYBUS_MAX_TRANSFER == JOYBUS_MAX_TRANSFER_BYTES, "joybus_packet must hold every transfer" );
+static_assert( sizeof( joybus_state ) == sizeof( GameCubeControllerState ), "joybus_state must match the controller state" );
+
+struct joybus_decoder : public GameCubeControllerDecoderSink
+{
+    joybus_decoder( U32 sample_rate_hz, JoyBusDevice device, BitState initial_bit_state )
+        : mDevice( device ),
+          mStream( sample_rate_hz, initial_bit_state ),
+          mDecoder( &mStream, sample_rate_hz, this ),
+          mStarted( false ),
+          mCallback( nullptr ),
+          mUser( nullptr ),
+          mBatchSize( 1 ),
+          mReadIndex( 0 )
+    {
+    }
+
+    virtual void OnBit( U64 )
+    {
+    }
+
+    virtual void OnPacket( const JoyBusPacket& packet, const JoyBusCommandInfo* info, U64 start_sample, U64 end_sample )
+    {
+        joybus_packet out;
+        memset( &out, 0, sizeof( out ) );
+        out.start_sample = start_sample;
+        out.end_sample = end_sample;
+        out.command = packet.mCommand;
+        out.known = info != nullptr;
+        out.has_state = packet.mHasState;
+        out.arg_length = static_cast<uint8_t>( packet.mArgLength );
+        out.response_length = static_cast<uint8_t>( packet.mResponseLength );
+        memcpy( out.args, packet.mArgs, packet.mArgLength );
+        memcpy( out.response, packet.mResponse, packet.mResponseLength );
+        if( packet.mHasState )
+        {
+            memcpy( &out.state, &packet.mState, sizeof( out.state ) );
+        }
+
+        mPackets.push_back( out );
+    }
+
+    // decodes every packet known to be complete. with flush, the remaining packets are handed out even if
+    // they don't fill a batch
+    void Decode( bool flush )
+    {
+        switch( mDevice )
+        {
+        case DEVICE_N64:
+            DecodeWithProfile<N64Profile>();
+            break;
+        default:
+            DecodeWithProfile<GameCubeProfile>();
+            break;
+        }
+
+        mStream.Compact();
+        Deliver( flush );
+    }
+
+    template <class Profile>
+    void DecodeWithProfile()
+    {
+        if( !mStarted )
+        {
+            if( !mStream.IsDecodable() )
+            {
+                return;
+            }
+            mDecoder.Start();
+            mStarted = true;
+        }
+
+        while( mStream.IsDecodable() )
+        {
+            mDecoder.template DecodeNext<Profile>();
+        }
+    }
+
+    void Deliver( bool flush )
+    {
+        if( mCallback == nullptr )
+        {
+            return;
+        }
+
+        while( mPackets.size() - mReadIndex >= mBatchSize || ( flush && mReadIndex < mPackets.size() ) )
+        {
+            size_t count = std::min( mBatchSize, mPackets.size() - mReadIndex );
+            mCallback( mUser, &mPackets[ mReadIndex ], count );
+            mReadIndex += count;
+        }
+        CompactPackets();
+    }
+
+    size_t Read( joybus_packet* packets, size_t capacity )
+    {
+        size_t count = std::min( capacity, mPackets.size() - mReadIndex );
+        std::copy( mPackets.begin() + mReadIndex, mPackets.begin() + mReadIndex + count, packets );
+        mReadIndex += count;
+        CompactPackets();
+        return count;
+    }
+
+    void CompactPackets()
+    {
+        if( mReadIndex > mPackets.size() / 2 )
+        {
+            mPackets.erase( mPackets.begin(), mPackets.begin() + mReadIndex );
+            mReadIndex = 0;
+        }
+    }
+
+    JoyBusDevice mDevice;
+    GameCubeControllerEdgeStream mStream;
+    GameCubeControllerDecoder<GameCubeControllerEdgeStream> mDecoder;
+    bool mStarted;
+
+    joybus_packet_callback mCallback;
+    void* mUser;
+    size_t mBatchSize;
+
+    // packets not handed out yet start at mReadIndex
+    std::vector<joybus_packet> mPackets;
+    size_t mReadIndex;
+};
+
+uint32_t joybus_api_version( void )
+{
+    return JOYBUS_API_VERSION;
+}
+
+joybus_decoder* joybus_decoder_create( uint32_t sample_rate_hz, int device, int initial_level )
+{
+    if( sample_rate_hz == 0 || ( device != JOYBUS_DEVICE_GAMECUBE && device != JOYBUS_DEVICE_N64 ) )
+    {
+        return nullptr;
+    }
+
+    return new( std::nothrow )
+        joybus_decoder( sample_rate_hz, device == JOYBUS_DEVICE_N64 ? DEVICE_N64 : DEVICE_GAMECUBE, initial_level ? BIT_HIGH : BIT_LOW );
+}
+
+void joybus_decoder_destroy( joybus_decoder* decoder )
+{
+    delete decoder;
+}
+
+int joybus_decoder_set_callback( joybus_decoder* decoder, joybus_packet_callback callback, void* user, size_t batch_size )
+{
+    if( decoder == nullptr || batch_size == 0 )
+    {
+        return JOYBUS_ERROR_ARGUMENT;
+    }
+
+    decoder->mCallback = callback;
+    decoder->mUser = user;
+    decoder->mBatchSize = batch_size;
+    return JOYBUS_OK;
+}
+
+// nothing may throw across the c interface
+int joybus_decoder_push_edges( joybus_decoder* decoder, const uint64_t* samples, size_t count )
+{
+    if( decoder == nullptr || ( samples == nullptr && count > 0 ) )
+    {
+        return JOYBUS_ERROR_ARGUMENT;
+    }
+
+    try
+    {
+        if( !decoder->mStream.Push( samples, count ) )
+        {
+            return JOYBUS_ERROR_ARGUMENT;
+        }
+        decoder->Decode( false );
+    }
+    catch( const std::bad_alloc& )
+    {
+        return JOYBUS_ERROR_MEMORY;
+    }
+
+    return JOYBUS_OK;
+}
+
+int joybus_decoder_finish( joybus_decoder* decoder )
+{
+    if( decoder == nullptr )
+    {
+        return JOYBUS_ERROR_ARGUMENT;
+    }
+
+    try
+    {
+        decoder->mStream.Finish();
+        decoder->Decode( true );
+    }
+    catch( const std::bad_alloc& )
+    {
+        return JOYBUS_ERROR_MEMORY;
+    }
+
+    return JOYBUS_OK;
+}
+
+size_t joybus_decoder_read( joybus_decoder* decoder, joybus_packet* packets, size_t capacity )
+{
+    if( decoder == nullptr || packets == nullptr )
+    {
+        return 0;
+    }
+
+    return decoder->Read( packets, capacity );
+}
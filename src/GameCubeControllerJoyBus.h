@@ -0,0 +1,101 @@
+#ifndef GAMECUBECONTROLLER_JOYBUS
+#define GAMECUBECONTROLLER_JOYBUS
+
+/* a c interface to the joybus decoder, built as a shared library for tools outside of logic. edges of
+ * the data line are pushed in batches and decoded packets come back in batches, either through a
+ * callback or by reading them into a caller-provided array, so crossing a language boundary costs one
+ * call per batch rather than one per packet. the layout of joybus_packet only changes along with
+ * JOYBUS_API_VERSION */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined( _WIN32 )
+#if defined( JOYBUS_BUILD )
+#define JOYBUS_API __declspec( dllexport )
+#else
+#define JOYBUS_API __declspec( dllimport )
+#endif
+#else
+#define JOYBUS_API __attribute__( ( visibility( "default" ) ) )
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define JOYBUS_API_VERSION 1
+#define JOYBUS_MAX_TRANSFER 64
+
+enum
+{
+    JOYBUS_OK = 0,
+    JOYBUS_ERROR_ARGUMENT = -1,
+    JOYBUS_ERROR_MEMORY = -2
+};
+
+/* the command set to decode */
+enum
+{
+    JOYBUS_DEVICE_GAMECUBE = 0,
+    JOYBUS_DEVICE_N64 = 1
+};
+
+/* a controller state at full resolution, see GameCubeControllerState */
+typedef struct joybus_state
+{
+    uint8_t buttons[ 2 ];
+    /* stick x, stick y, c-stick x, c-stick y, l, r, analog a, analog b */
+    uint8_t axes[ 8 ];
+    /* bit n is set if axis n was reported */
+    uint8_t axes_present;
+} joybus_state;
+
+typedef struct joybus_packet
+{
+    uint64_t start_sample;
+    uint64_t end_sample;
+    uint8_t command;
+    /* 1 if the command has a known layout for the device, otherwise the bytes were split at the stop bits */
+    uint8_t known;
+    /* 1 if state was unpacked from the response */
+    uint8_t has_state;
+    uint8_t arg_length;
+    uint8_t response_length;
+    uint8_t reserved[ 3 ];
+    uint8_t args[ JOYBUS_MAX_TRANSFER ];
+    uint8_t response[ JOYBUS_MAX_TRANSFER ];
+    joybus_state state;
+    uint8_t reserved2[ 5 ];
+} joybus_packet;
+
+typedef struct joybus_decoder joybus_decoder;
+
+/* receives up to the batch size of packets at a time. the packets are only valid during the call */
+typedef void ( *joybus_packet_callback )( void* user, const joybus_packet* packets, size_t count );
+
+JOYBUS_API uint32_t joybus_api_version( void );
+
+/* initial_level is the level of the line before the first edge, normally 1 since the bus idles high.
+ * returns NULL if the arguments are invalid or memory runs out */
+JOYBUS_API joybus_decoder* joybus_decoder_create( uint32_t sample_rate_hz, int device, int initial_level );
+JOYBUS_API void joybus_decoder_destroy( joybus_decoder* decoder );
+
+/* without a callback, packets are kept until read with joybus_decoder_read */
+JOYBUS_API int joybus_decoder_set_callback( joybus_decoder* decoder, joybus_packet_callback callback, void* user, size_t batch_size );
+
+/* edges are the sample numbers of level changes, strictly increasing across all calls. packets are
+ * decoded as soon as they are known to be complete, which is once the line has idled for 100us */
+JOYBUS_API int joybus_decoder_push_edges( joybus_decoder* decoder, const uint64_t* samples, size_t count );
+
+/* decodes whatever is left, treating the line as idle after the last edge */
+JOYBUS_API int joybus_decoder_finish( joybus_decoder* decoder );
+
+/* moves up to capacity queued packets into packets and returns how many were moved */
+JOYBUS_API size_t joybus_decoder_read( joybus_decoder* decoder, joybus_packet* packets, size_t capacity );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* GAMECUBECONTROLLER_JOYBUS */
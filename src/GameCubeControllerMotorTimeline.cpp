@@ -0,0 +1,69 @@
+#include "GameCubeControllerMotorTimeline.h"
+
+GameCubeControllerMotorTimeline::GameCubeControllerMotorTimeline() : mWindowSamples( 0 ), mHasMode( false ), mCurrent()
+{
+}
+
+void GameCubeControllerMotorTimeline::Reset( U64 window_samples )
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+
+    mWindowSamples = window_samples;
+    mHasMode = false;
+    mSpans.clear();
+}
+
+bool GameCubeControllerMotorTimeline::SetMode( JoyBusMotorMode mode, U64 sample )
+{
+    // the worker thread is the only writer, so the common case needs no lock
+    if( mHasMode && mode == mCurrent.mMode )
+    {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock( mMutex );
+
+    if( mHasMode )
+    {
+        mCurrent.mEndSample = sample;
+        mSpans.push_back( mCurrent );
+
+        while( mWindowSamples != 0 && sample - mSpans.front().mEndSample > mWindowSamples )
+        {
+            mSpans.pop_front();
+        }
+    }
+
+    mCurrent.mStartSample = sample;
+    mCurrent.mEndSample = 0;
+    mCurrent.mMode = mode;
+    mHasMode = true;
+
+    return true;
+}
+
+bool GameCubeControllerMotorTimeline::GetLastSpan( GameCubeControllerMotorSpan& span )
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+
+    if( mSpans.empty() )
+    {
+        return false;
+    }
+
+    span = mSpans.back();
+    return true;
+}
+
+bool GameCubeControllerMotorTimeline::GetSpans( std::vector<GameCubeControllerMotorSpan>& spans )
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+
+    spans.assign( mSpans.begin(), mSpans.end() );
+    if( mHasMode )
+    {
+        spans.push_back( mCurrent );
+    }
+
+    return mHasMode;
+}
@@ -0,0 +1,50 @@
+#ifndef GAMECUBECONTROLLER_MOTOR_TIMELINE
+#define GAMECUBECONTROLLER_MOTOR_TIMELINE
+
+#include "GameCubeControllerCommands.h"
+
+#include <deque>
+#include <mutex>
+#include <vector>
+
+// a stretch of time the motor spent in one mode, from the command that set the mode up to the command
+// that changed it
+struct GameCubeControllerMotorSpan
+{
+    U64 mStartSample;
+    U64 mEndSample;
+    JoyBusMotorMode mMode;
+};
+
+// the rumble motor's modes over a capture as a list of spans. nearly every poll repeats the last mode,
+// so only changes are stored. with a window, spans which ended more than that many samples before the
+// newest change are dropped
+class GameCubeControllerMotorTimeline
+{
+  public:
+    GameCubeControllerMotorTimeline();
+
+    void Reset( U64 window_samples );
+
+    // called for every packet that sets the motor. returns true if the mode changed, or if it's the
+    // first one seen
+    bool SetMode( JoyBusMotorMode mode, U64 sample );
+
+    // the span that the last change ended. returns false if there is none
+    bool GetLastSpan( GameCubeControllerMotorSpan& span );
+    // copies the ended spans, followed by the one still running with mEndSample set to 0. returns false
+    // if no mode has been seen
+    bool GetSpans( std::vector<GameCubeControllerMotorSpan>& spans );
+
+  protected:
+    U64 mWindowSamples;
+
+    bool mHasMode;
+    GameCubeControllerMotorSpan mCurrent;
+    std::deque<GameCubeControllerMotorSpan> mSpans;
+
+    // changes are added by the worker thread while an export may be reading
+    std::mutex mMutex;
+};
+
+#endif // GAMECUBECONTROLLER_MOTOR_TIMELINE
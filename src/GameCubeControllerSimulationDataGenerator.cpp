@@ -3,8 +3,9 @@
 #include "GameCubeControllerAnalyzerSettings.h"
 
 #include <AnalyzerHelpers.h>
+#include <algorithm>
 
-GameCubeControllerSimulationDataGenerator::GameCubeControllerSimulationDataGenerator()
+GameCubeControllerSimulationDataGenerator::GameCubeControllerSimulationDataGenerator() : mReplayNextEdge( 0 )
 {
     mGamecubeGenerationState = mGamecubeGenerationLastState = GamecubeGenerationState::IdCmd;
 }
@@ -20,16 +21,86 @@ void GameCubeControllerSimulationDataGenerator::Initialize( U32 simulation_sampl
 
     mGamecubeSimulationData.SetChannel( mSettings->mInputChannel );
     mGamecubeSimulationData.SetSampleRate( simulation_sample_rate );
+
+    if( OpenReplay() )
+    {
+        mGamecubeSimulationData.SetInitialBitState( mReplay->GetInitialBitState() );
+        return;
+    }
+
     mGamecubeSimulationData.SetInitialBitState( BIT_HIGH );
     GenerateDelayLong();
 }
 
+// a capture that can't be opened falls back to the built-in traffic
+bool GameCubeControllerSimulationDataGenerator::OpenReplay()
+{
+    if( mSettings->mSimulationCapture.empty() )
+    {
+        return false;
+    }
+
+    GameCubeControllerCaptureOptions options;
+    options.mPath = mSettings->mSimulationCapture;
+
+    std::string error;
+    mReplay.reset( GameCubeControllerCapture::Open( options, error ) );
+    if( mReplay.get() == nullptr || !mReplay->ReadEdges( mReplayEdges ) )
+    {
+        mReplay.reset();
+        return false;
+    }
+
+    mReplayNextEdge = 0;
+    return true;
+}
+
+// edges are moved to the simulation's sample rate, which leaves them untouched when the rates match.
+// once the capture runs out, the line idles
+void GameCubeControllerSimulationDataGenerator::RunReplay( U64 newest_sample )
+{
+    U32 capture_rate = mReplay->GetSampleRate();
+    while( mGamecubeSimulationData.GetCurrentSampleNumber() < newest_sample )
+    {
+        if( mReplayNextEdge == mReplayEdges.size() )
+        {
+            mReplayNextEdge = 0;
+            if( !mReplay->ReadEdges( mReplayEdges ) )
+            {
+                mReplayEdges.clear();
+                GenerateDelayLong();
+                continue;
+            }
+        }
+
+        U64 edge = mReplayEdges[ mReplayNextEdge++ ];
+        if( capture_rate != mSimulationSampleRateHz )
+        {
+            edge = static_cast<U64>( static_cast<double>( edge ) * mSimulationSampleRateHz / capture_rate );
+        }
+
+        U64 current = mGamecubeSimulationData.GetCurrentSampleNumber();
+        for( U64 remaining = edge > current ? edge - current : 0; remaining > 0; )
+        {
+            U32 step = static_cast<U32>( std::min<U64>( remaining, 0x80000000 ) );
+            mGamecubeSimulationData.Advance( step );
+            remaining -= step;
+        }
+        mGamecubeSimulationData.Transition();
+    }
+}
+
 U32 GameCubeControllerSimulationDataGenerator::GenerateSimulationData( U64 largest_sample_requested, U32 sample_rate,
                                                                        SimulationChannelDescriptor** simulation_channel )
 {
     U64 adjusted_largest_sample_requested =
         AnalyzerHelpers::AdjustSimulationTargetSample( largest_sample_requested, sample_rate, mSimulationSampleRateHz );
 
+    if( mReplay.get() != nullptr )
+    {
+        RunReplay( adjusted_largest_sample_requested );
+    }
+
     while( mGamecubeSimulationData.GetCurrentSampleNumber() < adjusted_largest_sample_requested )
     {
         RunStateMachine();
@@ -100,6 +171,16 @@ void GameCubeControllerSimulationDataGenerator::GenerateIdCmd()
 
 void GameCubeControllerSimulationDataGenerator::GenerateIdResp()
 {
+    if( mSettings->mDevice == DEVICE_N64 )
+    {
+        // controller info, pak inserted
+        GenerateByte( 0x05 );
+        GenerateByte( 0x00 );
+        GenerateByte( 0x01 );
+        GenerateStopBit();
+        return;
+    }
+
     // controller info
     GenerateByte( 0x09 );
     GenerateByte( 0x00 );
@@ -109,6 +190,21 @@ void GameCubeControllerSimulationDataGenerator::GenerateIdResp()
 
 void GameCubeControllerSimulationDataGenerator::GenerateOriginCmd()
 {
+    if( mSettings->mDevice == DEVICE_N64 )
+    {
+        // an n64 has no origin, start the rumble motor instead
+        U16 address = JoyBusAddressWithCrc( 0xC000 );
+        GenerateByte( 0x03 );
+        GenerateByte( address >> 8 );
+        GenerateByte( address & 0xFF );
+        for( int i = 0; i < 32; i++ )
+        {
+            GenerateByte( 0x01 );
+        }
+        GenerateStopBit();
+        return;
+    }
+
     // cmd
     GenerateByte( 0x41 );
     GenerateStopBit();
@@ -116,6 +212,19 @@ void GameCubeControllerSimulationDataGenerator::GenerateOriginCmd()
 
 void GameCubeControllerSimulationDataGenerator::GenerateOriginResp()
 {
+    if( mSettings->mDevice == DEVICE_N64 )
+    {
+        // data crc
+        U8 data[ 32 ];
+        for( int i = 0; i < 32; i++ )
+        {
+            data[ i ] = 0x01;
+        }
+        GenerateByte( JoyBusDataCrc( data ) );
+        GenerateStopBit();
+        return;
+    }
+
     // buttons0
     GenerateByte( 0x00 );
     // buttons1
@@ -141,16 +250,38 @@ void GameCubeControllerSimulationDataGenerator::GenerateOriginResp()
 
 void GameCubeControllerSimulationDataGenerator::GeneratePollCmd()
 {
+    if( mSettings->mDevice == DEVICE_N64 )
+    {
+        // cmd
+        GenerateByte( 0x01 );
+        GenerateStopBit();
+        return;
+    }
+
     // cmd
     GenerateByte( 0x40 );
-    // args
+    // args: poll mode 3, and the motor switching between on, brake and off every round of polls
     GenerateByte( 0x03 );
-    GenerateByte( 0x00 );
+    GenerateByte( mPollRounds % 3 == 0 ? 0x01 : mPollRounds % 3 == 1 ? 0x02 : 0x00 );
     GenerateStopBit();
 }
 
 void GameCubeControllerSimulationDataGenerator::GeneratePollResp()
 {
+    if( mSettings->mDevice == DEVICE_N64 )
+    {
+        // buttons0
+        GenerateByte( 0x00 );
+        // buttons1
+        GenerateByte( 0x00 );
+        // joystick x
+        GenerateByte( 0x00 );
+        // joystick y
+        GenerateByte( 0x00 );
+        GenerateStopBit();
+        return;
+    }
+
     // buttons0
     GenerateByte( 0x00 );
     // buttons1
@@ -231,6 +362,7 @@ void GameCubeControllerSimulationDataGenerator::RunStateMachine()
             {
                 mGamecubeGenerationState = GamecubeGenerationState::DelayLong;
                 mPollCmds = POLL_CMDS;
+                mPollRounds++;
             }
             break;
         default:
@@ -1,8 +1,12 @@
 #ifndef GAMECUBECONTROLLER_SIMULATION_DATA_GENERATOR
 #define GAMECUBECONTROLLER_SIMULATION_DATA_GENERATOR
 
+#include "GameCubeControllerCapture.h"
+
 #include <SimulationChannelDescriptor.h>
+#include <memory>
 #include <string>
+#include <vector>
 class GameCubeControllerAnalyzerSettings;
 
 class GameCubeControllerSimulationDataGenerator
@@ -54,10 +58,19 @@ class GameCubeControllerSimulationDataGenerator
 
     void RunStateMachine();
 
+    // replays the edges of a capture instead, see GameCubeControllerAnalyzerSettings::mSimulationCapture
+    bool OpenReplay();
+    void RunReplay( U64 newest_sample );
+
     GamecubeGenerationState mGamecubeGenerationState, mGamecubeGenerationLastState;
     int mIdCmds = ID_CMDS;
     int mPollCmds = POLL_CMDS;
+    int mPollRounds = 0;
 
     SimulationChannelDescriptor mGamecubeSimulationData;
+
+    std::auto_ptr<GameCubeControllerCapture> mReplay;
+    std::vector<U64> mReplayEdges;
+    size_t mReplayNextEdge;
 };
 #endif // GAMECUBECONTROLLER_SIMULATION_DATA_GENERATOR
\ No newline at end of file
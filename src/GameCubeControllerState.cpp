@@ -0,0 +1,207 @@
+#include "GameCubeControllerState.h"
+
+#include "GameCubeControllerText.h"
+
+const char* const GAMECUBE_AXIS_NAMES[ AXIS_COUNT ] = {
+    "Joystick X", "Joystick Y", "C-Stick X", "C-Stick Y", "L Analog", "R Analog", "A Analog", "B Analog",
+};
+
+const char* const GAMECUBE_AXIS_OFFSET_NAMES[ AXIS_COUNT ] = {
+    "Joystick X Offset", "Joystick Y Offset", "C-Stick X Offset", "C-Stick Y Offset",
+    "L Analog Offset",   "R Analog Offset",   "A Analog Offset",  "B Analog Offset",
+};
+
+const char* const GAMECUBE_BUTTON_NAMES[ BUTTON_COUNT ] = {
+    "A",      "B",       "X",      "Y",    "Start", "Get Origin", "Error Latch", "Error Status",
+    "D-Left", "D-Right", "D-Down", "D-Up", "Z",     "R",          "L",           "Use Origin",
+};
+
+namespace
+{
+    struct FieldName
+    {
+        const char* mName;
+        U32 mFields;
+    };
+
+    const FieldName FIELD_NAMES[] = {
+        { "Buttons", FIELD_BUTTONS }, { "Poll Mode", FIELD_POLL_MODE },       { "Motor Mode", FIELD_MOTOR_MODE },
+        { "State", FIELD_STATE },     { "Offsets", FIELD_ORIGIN_OFFSETS },
+    };
+
+    U32 FindField( const std::string& name )
+    {
+        for( const FieldName& field : FIELD_NAMES )
+        {
+            if( EqualsIgnoreCase( name, field.mName ) )
+                return field.mFields;
+        }
+        for( U32 i = 0; i < AXIS_COUNT; i++ )
+        {
+            if( EqualsIgnoreCase( name, GAMECUBE_AXIS_NAMES[ i ] ) )
+                return 1 << i;
+        }
+        return 0;
+    }
+
+    // every axis is ( response[ mByte ] << mShift ) & mMask: a full byte, a high nibble used as-is, or
+    // a low nibble shifted into the high nibble. a mask of 0 means the axis isn't reported
+    struct AxisUnpack
+    {
+        U8 mByte;
+        U8 mShift;
+        U8 mMask;
+    };
+
+#define FULL( byte ) { byte, 0, 0xFF }
+#define HIGH( byte ) { byte, 0, 0xF0 }
+#define LOW( byte ) { byte, 4, 0xF0 }
+#define NONE { 0, 0, 0x00 }
+
+    // see https://github.com/dolphin-emu/dolphin/blob/master/Source/Core/Core/HW/SI/SI_DeviceGCController.cpp
+    const AxisUnpack UNPACK[ POLL_MODE_COUNT + 1 ][ AXIS_COUNT ] = {
+        // stick x, stick y, c-stick x, c-stick y, l, r, a, b
+        { FULL( 2 ), FULL( 3 ), FULL( 4 ), FULL( 5 ), HIGH( 6 ), LOW( 6 ), HIGH( 7 ), LOW( 7 ) },
+        { FULL( 2 ), FULL( 3 ), HIGH( 4 ), LOW( 4 ), FULL( 5 ), FULL( 6 ), HIGH( 7 ), LOW( 7 ) },
+        { FULL( 2 ), FULL( 3 ), HIGH( 4 ), LOW( 4 ), HIGH( 5 ), LOW( 5 ), FULL( 6 ), FULL( 7 ) },
+        { FULL( 2 ), FULL( 3 ), FULL( 4 ), FULL( 5 ), FULL( 6 ), FULL( 7 ), NONE, NONE },
+        { FULL( 2 ), FULL( 3 ), FULL( 4 ), FULL( 5 ), NONE, NONE, FULL( 6 ), FULL( 7 ) },
+        { FULL( 2 ), FULL( 3 ), FULL( 4 ), FULL( 5 ), HIGH( 6 ), LOW( 6 ), HIGH( 7 ), LOW( 7 ) },
+        { FULL( 2 ), FULL( 3 ), FULL( 4 ), FULL( 5 ), HIGH( 6 ), LOW( 6 ), HIGH( 7 ), LOW( 7 ) },
+        { FULL( 2 ), FULL( 3 ), FULL( 4 ), FULL( 5 ), HIGH( 6 ), LOW( 6 ), HIGH( 7 ), LOW( 7 ) },
+        // POLL_MODE_FULL
+        { FULL( 2 ), FULL( 3 ), FULL( 4 ), FULL( 5 ), FULL( 6 ), FULL( 7 ), FULL( 8 ), FULL( 9 ) },
+    };
+
+#undef FULL
+#undef HIGH
+#undef LOW
+#undef NONE
+}
+
+bool UnpackControllerState( const U8* response, U32 response_length, U32 poll_mode, GameCubeControllerState& state )
+{
+    if( response_length < 2 )
+    {
+        return false;
+    }
+
+    state.mButtons[ 0 ] = response[ 0 ];
+    state.mButtons[ 1 ] = response[ 1 ];
+    state.mAxesPresent = 0;
+
+    // only the low bits of the poll mode argument select the layout
+    const AxisUnpack* unpack = UNPACK[ poll_mode == POLL_MODE_FULL ? POLL_MODE_FULL : poll_mode % POLL_MODE_COUNT ];
+
+    for( U32 i = 0; i < AXIS_COUNT; i++ )
+    {
+        const AxisUnpack& axis = unpack[ i ];
+        bool present = axis.mMask != 0 && axis.mByte < response_length;
+
+        state.mAxes[ i ] = present ? static_cast<U8>( response[ axis.mByte ] << axis.mShift ) & axis.mMask : 0;
+        state.mAxesPresent |= present << i;
+    }
+
+    return true;
+}
+
+bool ParseFrameFields( const char* text, U32& fields, std::string& error )
+{
+    fields = 0;
+
+    std::string list = text;
+    size_t start = 0;
+    while( start <= list.size() )
+    {
+        size_t end = list.find( ',', start );
+        if( end == std::string::npos )
+            end = list.size();
+
+        size_t first = list.find_first_not_of( " \t", start );
+        size_t last = list.find_last_not_of( " \t", end - 1 );
+        if( first < end && last != std::string::npos && last >= first )
+        {
+            std::string name = list.substr( first, last - first + 1 );
+            U32 field = FindField( name );
+            if( field == 0 )
+            {
+                error = "unknown field \"" + name + "\"";
+                return false;
+            }
+            fields |= field;
+        }
+
+        start = end + 1;
+    }
+
+    if( fields == 0 )
+        fields = FIELD_ALL;
+    return true;
+}
+
+void AddControllerState( const GameCubeControllerState& state, U32 fields, FrameV2& frame_v2 )
+{
+    if( fields & FIELD_BUTTONS )
+    {
+        if( fields & FIELD_NAMED_BUTTONS )
+        {
+            // the top bit is always set, so naming it would only add noise
+            AddButtonNames( ( state.mButtons[ 0 ] | ( state.mButtons[ 1 ] << 8 ) ) & 0x7FFF, GAMECUBE_BUTTON_NAMES, frame_v2 );
+        }
+        else
+        {
+            // buttons are displayed as a 16-bit value, so the first byte on the wire ends up last
+            U8 buttons[ 2 ] = { state.mButtons[ 1 ], state.mButtons[ 0 ] };
+            frame_v2.AddByteArray( "Buttons", buttons, sizeof( buttons ) );
+        }
+    }
+
+    U8 present = state.mAxesPresent & fields;
+    for( U32 i = 0; i < AXIS_COUNT; i++ )
+    {
+        if( present & ( 1 << i ) )
+        {
+            frame_v2.AddByte( GAMECUBE_AXIS_NAMES[ i ], state.mAxes[ i ] );
+        }
+    }
+
+    if( fields & FIELD_STATE )
+    {
+        frame_v2.AddByteArray( "State", reinterpret_cast<const U8*>( &state ), sizeof( state ) );
+    }
+}
+
+void AddOriginOffsets( const GameCubeControllerState& state, const GameCubeControllerState& origin, U32 fields, FrameV2& frame_v2 )
+{
+    if( !( fields & FIELD_ORIGIN_OFFSETS ) )
+        return;
+
+    U8 present = state.mAxesPresent & origin.mAxesPresent & fields;
+    for( U32 i = 0; i < AXIS_COUNT; i++ )
+    {
+        if( present & ( 1 << i ) )
+        {
+            frame_v2.AddInteger( GAMECUBE_AXIS_OFFSET_NAMES[ i ], state.mAxes[ i ] - origin.mAxes[ i ] );
+        }
+    }
+}
+
+void AddButtonNames( U16 buttons, const char* const* names, FrameV2& frame_v2 )
+{
+    // sixteen short names fit easily, so the text is built without allocating
+    char text[ 256 ];
+    size_t length = 0;
+    for( U32 i = 0; i < BUTTON_COUNT && length < sizeof( text ) - 2; i++ )
+    {
+        if( !( buttons & ( 1 << i ) ) || names[ i ] == nullptr )
+            continue;
+
+        if( length != 0 )
+            text[ length++ ] = '+';
+        for( const char* c = names[ i ]; *c != 0 && length < sizeof( text ) - 1; c++ )
+            text[ length++ ] = *c;
+    }
+    text[ length ] = 0;
+
+    frame_v2.AddString( "Buttons", text );
+}
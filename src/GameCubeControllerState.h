@@ -0,0 +1,75 @@
+#ifndef GAMECUBECONTROLLER_STATE
+#define GAMECUBECONTROLLER_STATE
+
+#include <AnalyzerResults.h>
+#include <string>
+
+enum GameCubeControllerAxis
+{
+    AXIS_STICK_X,
+    AXIS_STICK_Y,
+    AXIS_C_STICK_X,
+    AXIS_C_STICK_Y,
+    AXIS_L,
+    AXIS_R,
+    AXIS_A,
+    AXIS_B,
+    AXIS_COUNT,
+};
+
+// the frame field name of each axis, and of its offset from the origin
+extern const char* const GAMECUBE_AXIS_NAMES[ AXIS_COUNT ];
+extern const char* const GAMECUBE_AXIS_OFFSET_NAMES[ AXIS_COUNT ];
+
+// buttons are numbered by their bit in the two button bytes, in wire order
+static const U32 BUTTON_COUNT = 16;
+extern const char* const GAMECUBE_BUTTON_NAMES[ BUTTON_COUNT ];
+
+// the controller state fields of a frame as a mask, so unwanted fields are never added. every axis uses
+// the bit of its index
+static const U32 FIELD_BUTTONS = 1 << AXIS_COUNT;
+static const U32 FIELD_POLL_MODE = 1 << ( AXIS_COUNT + 1 );
+static const U32 FIELD_MOTOR_MODE = 1 << ( AXIS_COUNT + 2 );
+static const U32 FIELD_STATE = 1 << ( AXIS_COUNT + 3 );
+static const U32 FIELD_ORIGIN_OFFSETS = 1 << ( AXIS_COUNT + 4 );
+static const U32 FIELD_ALL = ( 1 << ( AXIS_COUNT + 5 ) ) - 1;
+// not a field of its own: buttons are added as the names of the pressed buttons instead of a raw word
+static const U32 FIELD_NAMED_BUTTONS = 1 << ( AXIS_COUNT + 5 );
+
+// parses field names separated by ',', e.g. "Buttons, Joystick X, Joystick Y". an empty list selects
+// every field
+bool ParseFrameFields( const char* text, U32& fields, std::string& error );
+
+// the poll modes a status command can request. modes 5-7 use the same layout as mode 0, and
+// POLL_MODE_FULL is the layout of the origin, recalibrate and long status responses
+static const U32 POLL_MODE_COUNT = 8;
+static const U32 POLL_MODE_FULL = POLL_MODE_COUNT;
+
+// controller state at full resolution. fields which the poll mode packs into a nibble are scaled
+// back up to 8 bits (the nibble becomes the high nibble), so every axis can be compared regardless of
+// poll mode. all members are bytes, so the struct is packed and can be exported as-is
+struct GameCubeControllerState
+{
+    // buttons in wire order: [ 0 ] = 0 0 0 Start Y X B A, [ 1 ] = 1 L R Z Up Down Right Left
+    U8 mButtons[ 2 ];
+    U8 mAxes[ AXIS_COUNT ];
+    // bit n is set if axis n was reported. axes the poll mode leaves out, or which were cut off by a
+    // truncated response, read as 0
+    U8 mAxesPresent;
+};
+
+static_assert( sizeof( GameCubeControllerState ) == 2 + AXIS_COUNT + 1, "controller state must be packed" );
+
+// unpacks a status, origin, recalibrate or long status response using the precomputed layout of the
+// poll mode. returns false if the buttons weren't received
+bool UnpackControllerState( const U8* response, U32 response_length, U32 poll_mode, GameCubeControllerState& state );
+
+// adds the selected buttons, present axes and packed state fields to a frame
+void AddControllerState( const GameCubeControllerState& state, U32 fields, FrameV2& frame_v2 );
+// adds how far every selected axis reported by both the state and the origin is from the origin
+void AddOriginOffsets( const GameCubeControllerState& state, const GameCubeControllerState& origin, U32 fields, FrameV2& frame_v2 );
+// adds a "Buttons" field naming the set bits of buttons joined by '+', bit n being names[ n ]. bits
+// without a name are left out
+void AddButtonNames( U16 buttons, const char* const* names, FrameV2& frame_v2 );
+
+#endif // GAMECUBECONTROLLER_STATE
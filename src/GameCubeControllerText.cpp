@@ -0,0 +1,15 @@
+#include "GameCubeControllerText.h"
+
+#include <cctype>
+
+bool EqualsIgnoreCase( const std::string& a, const char* b )
+{
+    size_t i = 0;
+    for( ; i < a.size() && b[ i ] != 0; i++ )
+    {
+        // tolower is undefined for negative chars other than EOF
+        if( tolower( static_cast<unsigned char>( a[ i ] ) ) != tolower( static_cast<unsigned char>( b[ i ] ) ) )
+            return false;
+    }
+    return i == a.size() && b[ i ] == 0;
+}
@@ -0,0 +1,9 @@
+#ifndef GAMECUBECONTROLLER_TEXT
+#define GAMECUBECONTROLLER_TEXT
+
+#include <string>
+
+// compares ascii text without regard to case, for the names typed into settings and file extensions
+bool EqualsIgnoreCase( const std::string& a, const char* b );
+
+#endif // GAMECUBECONTROLLER_TEXT
@@ -0,0 +1,308 @@
+#include "GameCubeControllerTrigger.h"
+
+#include "GameCubeControllerText.h"
+
+#include <cstdlib>
+
+namespace
+{
+    struct InputName
+    {
+        const char* mName;
+        U32 mIndex;
+    };
+
+    // the bit of each button in the two button bytes, in wire order
+    const InputName BUTTONS[] = {
+        { "A", 0 },     { "B", 1 },      { "X", 2 },     { "Y", 3 },  { "Start", 4 }, { "Left", 8 }, { "Right", 9 },
+        { "Down", 10 }, { "Up", 11 },    { "Z", 12 },    { "R", 13 }, { "L", 14 },
+    };
+
+    const InputName AXES[] = {
+        { "SX", AXIS_STICK_X }, { "SY", AXIS_STICK_Y }, { "CX", AXIS_C_STICK_X }, { "CY", AXIS_C_STICK_Y },
+        { "LA", AXIS_L },       { "RA", AXIS_R },       { "AA", AXIS_A },         { "BA", AXIS_B },
+    };
+
+    std::string Trim( const std::string& text )
+    {
+        size_t first = text.find_first_not_of( " \t" );
+        size_t last = text.find_last_not_of( " \t" );
+        return first == std::string::npos ? std::string() : text.substr( first, last - first + 1 );
+    }
+
+    std::vector<std::string> Split( const std::string& text, char separator )
+    {
+        std::vector<std::string> parts;
+        size_t start = 0;
+        while( true )
+        {
+            size_t end = text.find( separator, start );
+            parts.push_back( Trim( text.substr( start, end == std::string::npos ? std::string::npos : end - start ) ) );
+            if( end == std::string::npos )
+                return parts;
+            start = end + 1;
+        }
+    }
+
+    bool ParseNumber( const std::string& text, U64 max, U64& value )
+    {
+        std::string trimmed = Trim( text );
+        if( trimmed.empty() )
+            return false;
+
+        char* end;
+        value = strtoull( trimmed.c_str(), &end, 0 );
+        return *end == '\0' && value <= max;
+    }
+}
+
+GameCubeControllerTrigger::GameCubeControllerTrigger()
+{
+}
+
+bool GameCubeControllerTrigger::Compile( const char* text, std::string& error )
+{
+    mPatterns.clear();
+
+    std::vector<std::string> patterns = Split( text, ';' );
+    for( size_t i = 0; i < patterns.size(); i++ )
+    {
+        if( patterns[ i ].empty() )
+            continue;
+
+        if( mPatterns.size() == MAX_PATTERNS )
+        {
+            error = "Too many input patterns";
+            mPatterns.clear();
+            return false;
+        }
+
+        Pattern pattern;
+        if( !ParsePattern( patterns[ i ], pattern, error ) )
+        {
+            error = "Input pattern \"" + patterns[ i ] + "\": " + error;
+            mPatterns.clear();
+            return false;
+        }
+        mPatterns.push_back( pattern );
+    }
+
+    return true;
+}
+
+bool GameCubeControllerTrigger::ParsePattern( const std::string& text, Pattern& pattern, std::string& error )
+{
+    pattern.mText = text;
+    pattern.mWindowMs = 0;
+
+    std::string steps = text;
+    for( size_t i = 0; i + 6 <= text.size(); i++ )
+    {
+        if( EqualsIgnoreCase( text.substr( i, 6 ), "within" ) )
+        {
+            std::string window = Trim( text.substr( i + 6 ) );
+            if( window.size() >= 2 && EqualsIgnoreCase( window.substr( window.size() - 2 ), "ms" ) )
+                window = window.substr( 0, window.size() - 2 );
+
+            if( !ParseNumber( window, 0xFFFFFFFF, pattern.mWindowMs ) || pattern.mWindowMs == 0 )
+            {
+                error = "expected a time in ms after \"within\"";
+                return false;
+            }
+            steps = text.substr( 0, i );
+            break;
+        }
+    }
+
+    std::vector<std::string> step_texts = Split( steps, ',' );
+    for( size_t i = 0; i < step_texts.size(); i++ )
+    {
+        Step step = {};
+        for( U32 axis = 0; axis < AXIS_COUNT; axis++ )
+            step.mMax[ axis ] = 0xFF;
+
+        std::vector<std::string> terms = Split( step_texts[ i ], '+' );
+        for( size_t j = 0; j < terms.size(); j++ )
+        {
+            if( !ParseTerm( terms[ j ], step, error ) )
+                return false;
+        }
+        pattern.mSteps.push_back( step );
+    }
+
+    return true;
+}
+
+bool GameCubeControllerTrigger::ParseTerm( const std::string& term, Step& step, std::string& error )
+{
+    if( term.empty() )
+    {
+        error = "missing input";
+        return false;
+    }
+
+    // axis comparison
+    size_t op = term.find_first_of( "<>=" );
+    if( op != std::string::npos )
+    {
+        std::string name = Trim( term.substr( 0, op ) );
+        const InputName* axis = nullptr;
+        for( const InputName& candidate : AXES )
+        {
+            if( EqualsIgnoreCase( name, candidate.mName ) )
+                axis = &candidate;
+        }
+        if( axis == nullptr )
+        {
+            error = "unknown axis \"" + name + "\"";
+            return false;
+        }
+
+        std::string op_text = term.substr( op, term.size() > op + 1 && term[ op + 1 ] == '=' ? 2 : 1 );
+        std::string value_text = term.substr( op + op_text.size() );
+        U8& min = step.mMin[ axis->mIndex ];
+        U8& max = step.mMax[ axis->mIndex ];
+        U64 value, upper;
+
+        size_t range = value_text.find( ".." );
+        if( op_text == "=" && range != std::string::npos )
+        {
+            if( !ParseNumber( value_text.substr( 0, range ), 0xFF, value ) || !ParseNumber( value_text.substr( range + 2 ), 0xFF, upper ) ||
+                value > upper )
+            {
+                error = "invalid range in \"" + term + "\"";
+                return false;
+            }
+            min = value;
+            max = upper;
+        }
+        else if( !ParseNumber( value_text, 0xFF, value ) || ( op_text == "<" && value == 0 ) || ( op_text == ">" && value == 0xFF ) )
+        {
+            error = "invalid value in \"" + term + "\"";
+            return false;
+        }
+        else if( op_text == "<" )
+            max = value - 1;
+        else if( op_text == "<=" )
+            max = value;
+        else if( op_text == ">" )
+            min = value + 1;
+        else if( op_text == ">=" )
+            min = value;
+        else
+            min = max = value;
+
+        step.mAxisMask |= 1 << axis->mIndex;
+        return true;
+    }
+
+    // button, optionally negated
+    bool pressed = term[ 0 ] != '!';
+    std::string name = Trim( pressed ? term : term.substr( 1 ) );
+    for( const InputName& button : BUTTONS )
+    {
+        if( EqualsIgnoreCase( name, button.mName ) || EqualsIgnoreCase( name, GAMECUBE_BUTTON_NAMES[ button.mIndex ] ) )
+        {
+            step.mButtonMask |= 1 << button.mIndex;
+            if( pressed )
+                step.mButtonValue |= 1 << button.mIndex;
+            return true;
+        }
+    }
+
+    error = "unknown button \"" + name + "\"";
+    return false;
+}
+
+void GameCubeControllerTrigger::Reset( U32 sample_rate_hz )
+{
+    for( size_t i = 0; i < mPatterns.size(); i++ )
+    {
+        Pattern& pattern = mPatterns[ i ];
+        pattern.mWindowSamples = pattern.mWindowMs * sample_rate_hz / 1000;
+        pattern.mNextStep = 0;
+        pattern.mStartSample = 0;
+        pattern.mFirstStepMatched = false;
+    }
+}
+
+bool GameCubeControllerTrigger::IsEmpty() const
+{
+    return mPatterns.empty();
+}
+
+U32 GameCubeControllerTrigger::GetPatternCount() const
+{
+    return static_cast<U32>( mPatterns.size() );
+}
+
+const std::string& GameCubeControllerTrigger::GetPatternText( U32 pattern ) const
+{
+    return mPatterns[ pattern ].mText;
+}
+
+bool GameCubeControllerTrigger::Matches( const Step& step, const GameCubeControllerState& state )
+{
+    U16 buttons = state.mButtons[ 0 ] | ( state.mButtons[ 1 ] << 8 );
+    if( ( buttons & step.mButtonMask ) != step.mButtonValue )
+    {
+        return false;
+    }
+
+    // an axis the poll mode didn't report can't satisfy a comparison
+    if( ( step.mAxisMask & state.mAxesPresent ) != step.mAxisMask )
+    {
+        return false;
+    }
+
+    for( U32 i = 0; i < AXIS_COUNT; i++ )
+    {
+        if( ( step.mAxisMask & ( 1 << i ) ) && ( state.mAxes[ i ] < step.mMin[ i ] || state.mAxes[ i ] > step.mMax[ i ] ) )
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+U32 GameCubeControllerTrigger::Evaluate( U64 sample, const GameCubeControllerState& state )
+{
+    U32 matches = 0;
+
+    for( size_t i = 0; i < mPatterns.size(); i++ )
+    {
+        Pattern& pattern = mPatterns[ i ];
+
+        // the first step triggers on the transition into matching, so a held combination matches once
+        bool first_step = Matches( pattern.mSteps[ 0 ], state );
+        bool started = first_step && !pattern.mFirstStepMatched;
+        pattern.mFirstStepMatched = first_step;
+
+        if( pattern.mNextStep > 0 && pattern.mWindowSamples > 0 && sample - pattern.mStartSample > pattern.mWindowSamples )
+        {
+            pattern.mNextStep = 0;
+        }
+
+        if( pattern.mNextStep == 0 )
+        {
+            if( started )
+            {
+                pattern.mStartSample = sample;
+                pattern.mNextStep = 1;
+            }
+        }
+        else if( Matches( pattern.mSteps[ pattern.mNextStep ], state ) )
+        {
+            pattern.mNextStep++;
+        }
+
+        if( pattern.mNextStep == pattern.mSteps.size() )
+        {
+            matches |= 1u << i;
+            pattern.mNextStep = 0;
+        }
+    }
+
+    return matches;
+}
@@ -0,0 +1,69 @@
+#ifndef GAMECUBECONTROLLER_TRIGGER
+#define GAMECUBECONTROLLER_TRIGGER
+
+#include "GameCubeControllerState.h"
+
+#include <string>
+#include <vector>
+
+// matches input patterns against every decoded controller state. patterns are compiled from text:
+//
+//   patterns := pattern ( ';' pattern )*
+//   pattern  := step ( ',' step )* [ 'within' number 'ms' ]
+//   step     := term ( '+' term )*
+//   term     := [ '!' ] button | axis ( '<' | '<=' | '>' | '>=' | '=' ) number | axis '=' number '..' number
+//
+// buttons are A, B, X, Y, Start, Z, L, R, Up, Down, Left and Right. axes are SX, SY (stick), CX, CY
+// (c-stick), LA, RA (analog triggers), AA and BA (analog buttons). a pattern matches when its first
+// step starts matching and the remaining steps match on later states, in order, within the time limit.
+// for example "L+R+A+Start" or "SX<64, SX>192 within 100ms"
+class GameCubeControllerTrigger
+{
+  public:
+    static const U32 MAX_PATTERNS = 32;
+
+    GameCubeControllerTrigger();
+
+    // returns false and describes the problem in error if the text can't be compiled
+    bool Compile( const char* text, std::string& error );
+    void Reset( U32 sample_rate_hz );
+
+    bool IsEmpty() const;
+    U32 GetPatternCount() const;
+    const std::string& GetPatternText( U32 pattern ) const;
+
+    // returns a bitmask of the patterns which completed on this state
+    U32 Evaluate( U64 sample, const GameCubeControllerState& state );
+
+  protected:
+    // a step is a bitmask test on the buttons plus an inclusive range test on each constrained axis
+    struct Step
+    {
+        U16 mButtonMask;
+        U16 mButtonValue;
+        U8 mAxisMask;
+        U8 mMin[ AXIS_COUNT ];
+        U8 mMax[ AXIS_COUNT ];
+    };
+
+    struct Pattern
+    {
+        std::string mText;
+        std::vector<Step> mSteps;
+        U64 mWindowMs;
+
+        // matching state
+        U64 mWindowSamples;
+        size_t mNextStep;
+        U64 mStartSample;
+        bool mFirstStepMatched;
+    };
+
+    static bool Matches( const Step& step, const GameCubeControllerState& state );
+    static bool ParsePattern( const std::string& text, Pattern& pattern, std::string& error );
+    static bool ParseTerm( const std::string& term, Step& step, std::string& error );
+
+    std::vector<Pattern> mPatterns;
+};
+
+#endif // GAMECUBECONTROLLER_TRIGGER
@@ -0,0 +1,774 @@
+// decodes the captures in test/fixtures four ways: from the imported capture, through the c interface
+// and through the edge cache, once filling it and once replaying it. every way has to give exactly the
+// packets in the .expected file next to the capture, and windows decoded from checkpoints the expected
+// packets starting within them. with --batch, the batch tool decodes them as well and its csvs have to
+// list the same packets, also for a window decoded from the checkpoints it kept. every capture is also
+// written to an archive and read back, which has to give exactly the same edges, and the decoder has to
+// keep up with the throughput recorded below. the event index's searches are checked against a scan of
+// its events. run with --update to rewrite the .expected files after an intended change to the
+// decoder's output
+
+#include "GameCubeControllerArchive.h"
+#include "GameCubeControllerCapture.h"
+#include "GameCubeControllerCheckpoints.h"
+#include "GameCubeControllerDecoder.h"
+#include "GameCubeControllerEdgeCache.h"
+#include "GameCubeControllerEventIndex.h"
+#include "GameCubeControllerJoyBus.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+    // traffic.vcd and adapter.vcd are clean traffic from a console and from a usb adapter, n64_traffic.vcd
+    // an n64 polling its controller. the rest are made by hand to take the decoder off its usual path
+    struct Fixture
+    {
+        const char* mName;
+        JoyBusDevice mDevice;
+    };
+
+    const Fixture FIXTURES[] = {
+        { "traffic", DEVICE_GAMECUBE },
+        { "adapter", DEVICE_GAMECUBE },
+        { "n64_traffic", DEVICE_N64 },
+        // a command without a known layout, with arguments and a response
+        { "unknown_command", DEVICE_GAMECUBE },
+        // a status response which stops after three bytes
+        { "truncated_response", DEVICE_GAMECUBE },
+        // a status command with a bit held low for 6us
+        { "long_low_pulse", DEVICE_GAMECUBE },
+        // a response cut off within a bit, with the next command following soon after
+        { "cut_bit", DEVICE_GAMECUBE },
+        // a line held low when the capture starts
+        { "starts_low", DEVICE_GAMECUBE },
+    };
+
+    // edges decoded per second from an imported capture, over the traffic fixture repeated
+    // THROUGHPUT_REPEATS times. a release build measured about 40 million and an unoptimized one about
+    // 20 million, the baselines leave room for slower machines
+#ifdef NDEBUG
+    const double THROUGHPUT_BASELINE = 12e6;
+#else
+    const double THROUGHPUT_BASELINE = 6e6;
+#endif
+    const U32 THROUGHPUT_REPEATS = 1000;
+
+    // the window the batch tool decodes from its checkpoints, in seconds
+    const char* const BATCH_WINDOW = "0.01,0.02";
+    const double BATCH_WINDOW_START_S = 0.01;
+    const double BATCH_WINDOW_END_S = 0.02;
+
+    // controller states given to the event index, about one every 1000 samples
+    const U32 EVENT_INDEX_STATES = 5000;
+
+    int gFailures = 0;
+
+    void Fail( const std::string& name, const std::string& message )
+    {
+        std::printf( "FAIL %s: %s\n", name.c_str(), message.c_str() );
+        gFailures++;
+    }
+
+    std::string FormatPacket( U64 start_sample, U64 end_sample, U8 command, const U8* args, U32 arg_length, const U8* response,
+                              U32 response_length )
+    {
+        char buffer[ 64 ];
+        std::snprintf( buffer, sizeof( buffer ), "%llu %llu %02X [", static_cast<unsigned long long>( start_sample ),
+                       static_cast<unsigned long long>( end_sample ), command );
+        std::string line = buffer;
+        for( U32 i = 0; i < arg_length; i++ )
+        {
+            std::snprintf( buffer, sizeof( buffer ), i == 0 ? "%02X" : " %02X", args[ i ] );
+            line += buffer;
+        }
+        line += "] [";
+        for( U32 i = 0; i < response_length; i++ )
+        {
+            std::snprintf( buffer, sizeof( buffer ), i == 0 ? "%02X" : " %02X", response[ i ] );
+            line += buffer;
+        }
+        return line + "]";
+    }
+
+    class PacketSink : public GameCubeControllerDecoderSink
+    {
+      public:
+        virtual void OnBit( U64 )
+        {
+        }
+
+        virtual void OnPacket( const JoyBusPacket& packet, const JoyBusCommandInfo*, U64 start_sample, U64 end_sample )
+        {
+            mPackets.push_back( FormatPacket( start_sample, end_sample, packet.mCommand, packet.mArgs, packet.mArgLength, packet.mResponse,
+                                              packet.mResponseLength ) );
+        }
+
+        std::vector<std::string> mPackets;
+    };
+
+    // edges held in memory, for captures larger than any fixture
+    class MemoryCapture : public GameCubeControllerCapture
+    {
+      public:
+        MemoryCapture( const std::vector<U64>& edges, U32 sample_rate_hz, BitState initial_bit_state )
+            : mEdges( edges ), mStartBitState( initial_bit_state ), mPosition( 0 )
+        {
+            mSampleRateHz = sample_rate_hz;
+            mInitialBitState = initial_bit_state;
+        }
+
+      protected:
+        virtual bool ReadChunk( std::vector<U64>& edges )
+        {
+            if( mPosition >= mEdges.size() )
+            {
+                return false;
+            }
+
+            size_t end = std::min<size_t>( mPosition + ( 1 << 16 ), mEdges.size() );
+            edges.assign( mEdges.begin() + mPosition, mEdges.begin() + end );
+            mPosition = end;
+            return true;
+        }
+
+        virtual void SeekBefore( U64 )
+        {
+            mPosition = 0;
+            mInitialBitState = mStartBitState;
+        }
+
+        const std::vector<U64>& mEdges;
+        BitState mStartBitState;
+        size_t mPosition;
+    };
+
+    GameCubeControllerCapture* OpenFixture( const std::string& path )
+    {
+        GameCubeControllerCaptureOptions options;
+        options.mPath = path;
+
+        std::string error;
+        GameCubeControllerCapture* capture = GameCubeControllerCapture::Open( options, error );
+        if( capture == nullptr )
+        {
+            Fail( path, error );
+        }
+        return capture;
+    }
+
+    // reads every edge of a capture, and the level before the first one
+    void ReadAllEdges( GameCubeControllerCapture& capture, std::vector<U64>& edges, BitState& initial_bit_state )
+    {
+        edges.clear();
+        std::vector<U64> chunk;
+        bool first = true;
+        while( capture.ReadEdges( chunk ) )
+        {
+            if( first )
+            {
+                initial_bit_state = capture.GetInitialBitState();
+                first = false;
+            }
+            edges.insert( edges.end(), chunk.begin(), chunk.end() );
+        }
+        if( first )
+        {
+            initial_bit_state = capture.GetInitialBitState();
+        }
+    }
+
+    std::vector<std::string> DecodeWithCaptureChannel( const std::string& path, JoyBusDevice device )
+    {
+        PacketSink sink;
+        std::unique_ptr<GameCubeControllerCapture> capture( OpenFixture( path ) );
+        if( capture )
+        {
+            DecodeCapture( *capture, device, sink );
+        }
+        return sink.mPackets;
+    }
+
+    std::vector<std::string> DecodeWithJoyBus( const std::vector<U64>& edges, U32 sample_rate_hz, BitState initial_bit_state,
+                                               JoyBusDevice device )
+    {
+        std::vector<std::string> packets;
+        joybus_decoder* decoder = joybus_decoder_create( sample_rate_hz, device == DEVICE_N64 ? JOYBUS_DEVICE_N64 : JOYBUS_DEVICE_GAMECUBE,
+                                                         initial_bit_state == BIT_HIGH ? 1 : 0 );
+        if( decoder == nullptr )
+        {
+            return packets;
+        }
+
+        // pushed in uneven batches, so packets straddle them
+        const size_t BATCH_EDGES = 1000;
+        std::vector<uint64_t> samples( edges.begin(), edges.end() );
+        for( size_t i = 0; i < samples.size(); i += BATCH_EDGES )
+        {
+            joybus_decoder_push_edges( decoder, &samples[ i ], std::min( BATCH_EDGES, samples.size() - i ) );
+        }
+        joybus_decoder_finish( decoder );
+
+        joybus_packet packet;
+        while( joybus_decoder_read( decoder, &packet, 1 ) == 1 )
+        {
+            packets.push_back( FormatPacket( packet.start_sample, packet.end_sample, packet.command, packet.args, packet.arg_length,
+                                             packet.response, packet.response_length ) );
+        }
+
+        joybus_decoder_destroy( decoder );
+        return packets;
+    }
+
+    // the cached channel has no end of its own, so decoding stops once it has passed the last edge
+    std::vector<std::string> DecodeWithCachedChannel( const std::string& path, GameCubeControllerEdgeCache& cache, U64 last_sample,
+                                                      JoyBusDevice device )
+    {
+        PacketSink sink;
+        std::unique_ptr<GameCubeControllerCapture> capture( OpenFixture( path ) );
+        if( !capture )
+        {
+            return sink.mPackets;
+        }
+
+        GameCubeControllerCaptureChannel live( capture.get() );
+        GameCubeControllerCachedChannel<GameCubeControllerCaptureChannel> channel( &live, &cache );
+        GameCubeControllerDecoder<GameCubeControllerCachedChannel<GameCubeControllerCaptureChannel>> decoder(
+            &channel, capture->GetSampleRate(), &sink );
+        decoder.Start();
+        while( channel.GetSampleNumber() < last_sample )
+        {
+            if( device == DEVICE_N64 )
+            {
+                decoder.DecodeNext<N64Profile>();
+            }
+            else
+            {
+                decoder.DecodeNext<GameCubeProfile>();
+            }
+        }
+        return sink.mPackets;
+    }
+
+    bool ReadLines( const std::string& path, std::vector<std::string>& lines )
+    {
+        std::ifstream file( path.c_str() );
+        if( !file )
+        {
+            return false;
+        }
+
+        lines.clear();
+        std::string line;
+        while( std::getline( file, line ) )
+        {
+            lines.push_back( line );
+        }
+        return true;
+    }
+
+    bool WriteLines( const std::string& path, const std::vector<std::string>& lines )
+    {
+        std::ofstream file( path.c_str() );
+        for( const std::string& line : lines )
+        {
+            file << line << '\n';
+        }
+        return static_cast<bool>( file );
+    }
+
+    void ComparePackets( const std::string& name, const char* way, const std::vector<std::string>& expected,
+                         const std::vector<std::string>& packets )
+    {
+        for( size_t i = 0; i < expected.size() || i < packets.size(); i++ )
+        {
+            const char* want = i < expected.size() ? expected[ i ].c_str() : "nothing";
+            const char* got = i < packets.size() ? packets[ i ].c_str() : "nothing";
+            if( std::strcmp( want, got ) != 0 )
+            {
+                std::ostringstream message;
+                message << way << " packet " << i << ": expected " << want << ", got " << got;
+                Fail( name, message.str() );
+                return;
+            }
+        }
+    }
+
+    // the expected packets starting within [ start_sample, end_sample )
+    std::vector<std::string> FilterPackets( const std::vector<std::string>& packets, U64 start_sample, U64 end_sample )
+    {
+        std::vector<std::string> filtered;
+        for( const std::string& packet : packets )
+        {
+            unsigned long long sample = 0;
+            if( std::sscanf( packet.c_str(), "%llu", &sample ) == 1 && sample >= start_sample && sample < end_sample )
+            {
+                filtered.push_back( packet );
+            }
+        }
+        return filtered;
+    }
+
+    // records checkpoints every few packets, so every window resumes from one, and saves and loads them
+    // before decoding windows at the start, in the middle and at the end of the capture
+    void CheckWindows( const std::string& name, const std::string& path, JoyBusDevice device, const std::vector<std::string>& expected,
+                       U64 last_sample )
+    {
+        std::unique_ptr<GameCubeControllerCapture> capture( OpenFixture( path ) );
+        if( !capture )
+        {
+            return;
+        }
+
+        GameCubeControllerCheckpoints recorded;
+        recorded.Reset( 4 );
+        PacketSink full;
+        DecodeCapture( *capture, device, full, &recorded );
+
+        // the capture's size is only compared, so any value stands in for it
+        std::string checkpoints_path = name + ".ckpt";
+        GameCubeControllerCheckpoints checkpoints;
+        GameCubeControllerCheckpoints other;
+        U32 sample_rate_hz = capture->GetSampleRate();
+        if( !recorded.Save( checkpoints_path.c_str(), 1, sample_rate_hz, device ) ||
+            !checkpoints.Load( checkpoints_path.c_str(), 1, sample_rate_hz, device ) || checkpoints.GetCount() != recorded.GetCount() )
+        {
+            Fail( name, "the checkpoints didn't load back" );
+            return;
+        }
+        if( other.Load( checkpoints_path.c_str(), 2, sample_rate_hz, device ) )
+        {
+            Fail( name, "checkpoints recorded from another capture were loaded" );
+        }
+        std::remove( checkpoints_path.c_str() );
+
+        const U64 windows[][ 2 ] = {
+            { 0, last_sample + 1 },
+            { 0, last_sample / 3 },
+            { last_sample / 3, last_sample * 2 / 3 },
+            { last_sample * 2 / 3, last_sample + 1 },
+        };
+        for( const U64* window : windows )
+        {
+            PacketSink sink;
+            DecodeCaptureWindow( *capture, device, checkpoints, window[ 0 ], window[ 1 ], sink );
+            ComparePackets( name, "window", FilterPackets( expected, window[ 0 ], window[ 1 ] ), sink.mPackets );
+        }
+    }
+
+    void CheckArchive( const std::string& name, const std::string& path, const std::vector<U64>& edges, U32 sample_rate_hz,
+                       BitState initial_bit_state )
+    {
+        std::unique_ptr<GameCubeControllerCapture> capture( OpenFixture( path ) );
+        if( !capture )
+        {
+            return;
+        }
+
+        std::string archive_path = name + ".jba";
+        std::string error;
+        if( !WriteCaptureArchive( *capture, archive_path.c_str(), error ) )
+        {
+            Fail( name, "writing the archive failed: " + error );
+            return;
+        }
+
+        std::unique_ptr<GameCubeControllerCapture> archive( OpenFixture( archive_path ) );
+        if( archive )
+        {
+            std::vector<U64> archived;
+            BitState archived_bit_state = BIT_HIGH;
+            ReadAllEdges( *archive, archived, archived_bit_state );
+            if( archive->GetSampleRate() != sample_rate_hz )
+            {
+                Fail( name, "the archive has a different sample rate" );
+            }
+            if( archived_bit_state != initial_bit_state )
+            {
+                Fail( name, "the archive starts at a different level" );
+            }
+            if( archived != edges )
+            {
+                Fail( name, "the archive has different edges" );
+            }
+        }
+        archive.reset();
+        std::remove( archive_path.c_str() );
+    }
+
+    void CheckFixture( const std::string& directory, const Fixture& fixture, bool update )
+    {
+        int failures = gFailures;
+        std::string name = fixture.mName;
+        std::string path = directory + "/" + name + ".vcd";
+        std::unique_ptr<GameCubeControllerCapture> capture( OpenFixture( path ) );
+        if( !capture )
+        {
+            return;
+        }
+
+        std::vector<U64> edges;
+        BitState initial_bit_state = BIT_HIGH;
+        ReadAllEdges( *capture, edges, initial_bit_state );
+        U32 sample_rate_hz = capture->GetSampleRate();
+        if( edges.empty() )
+        {
+            Fail( name, "the capture has no edges" );
+            return;
+        }
+
+        std::vector<std::string> packets = DecodeWithCaptureChannel( path, fixture.mDevice );
+
+        std::string expected_path = directory + "/" + name + ".expected";
+        std::vector<std::string> expected;
+        if( update )
+        {
+            if( !WriteLines( expected_path, packets ) )
+            {
+                Fail( name, "can't write " + expected_path );
+            }
+            expected = packets;
+        }
+        else if( !ReadLines( expected_path, expected ) )
+        {
+            Fail( name, "can't read " + expected_path );
+            return;
+        }
+
+        ComparePackets( name, "capture channel", expected, packets );
+        ComparePackets( name, "c interface", expected, DecodeWithJoyBus( edges, sample_rate_hz, initial_bit_state, fixture.mDevice ) );
+
+        GameCubeControllerEdgeCache cache;
+        ComparePackets( name, "filling the edge cache", expected, DecodeWithCachedChannel( path, cache, edges.back(), fixture.mDevice ) );
+        ComparePackets( name, "replaying the edge cache", expected, DecodeWithCachedChannel( path, cache, edges.back(), fixture.mDevice ) );
+
+        CheckWindows( name, path, fixture.mDevice, expected, edges.back() );
+        CheckArchive( name, path, edges, sample_rate_hz, initial_bit_state );
+
+        if( gFailures == failures )
+        {
+            std::printf( "ok %s: %u packets, %u edges\n", name.c_str(), static_cast<U32>( expected.size() ),
+                         static_cast<U32>( edges.size() ) );
+        }
+    }
+
+    std::vector<std::string> SplitCsvRow( const std::string& row )
+    {
+        std::vector<std::string> fields;
+        size_t start = 0;
+        for( size_t comma = row.find( ',' ); comma != std::string::npos; comma = row.find( ',', start ) )
+        {
+            fields.push_back( row.substr( start, comma - start ) );
+            start = comma + 1;
+        }
+        fields.push_back( row.substr( start ) );
+        return fields;
+    }
+
+    // the times and bytes of the expected packets, the way the batch tool writes them
+    std::vector<std::string> FormatBatchRows( const std::vector<std::string>& expected, U32 sample_rate_hz )
+    {
+        std::vector<std::string> rows;
+        for( const std::string& line : expected )
+        {
+            unsigned long long start_sample = 0, end_sample = 0;
+            size_t args = line.find( '[' );
+            size_t response = line.find( '[', args + 1 );
+            if( std::sscanf( line.c_str(), "%llu %llu", &start_sample, &end_sample ) != 2 || response == std::string::npos )
+            {
+                continue;
+            }
+
+            char times[ 64 ];
+            std::snprintf( times, sizeof( times ), "%.9f,%.9f,", start_sample / double( sample_rate_hz ),
+                           end_sample / double( sample_rate_hz ) );
+            rows.push_back( times + line.substr( args + 1, line.find( ']', args ) - args - 1 ) + "," +
+                            line.substr( response + 1, line.find( ']', response ) - response - 1 ) );
+        }
+        return rows;
+    }
+
+    // the same fields of the packets in a csv written by the batch tool. dropped packets have no fields
+    // to compare and are left out
+    bool ReadBatchRows( const std::string& path, std::vector<std::string>& rows )
+    {
+        std::vector<std::string> lines;
+        if( !ReadLines( path, lines ) )
+        {
+            return false;
+        }
+
+        rows.clear();
+        for( size_t i = 1; i < lines.size(); i++ )
+        {
+            std::vector<std::string> fields = SplitCsvRow( lines[ i ] );
+            if( fields.size() == 7 && fields[ 6 ] != "dropped" )
+            {
+                rows.push_back( fields[ 0 ] + "," + fields[ 1 ] + "," + fields[ 3 ] + "," + fields[ 4 ] );
+            }
+        }
+        return true;
+    }
+
+    // runs the batch tool over the fixtures once per device, writing its csvs to the working directory,
+    // and compares the csv of every fixture decoded as its own device
+    void CheckBatch( const std::string& directory, const std::string& tool )
+    {
+        // gamecube last, so its checkpoints are the ones kept for the window below
+        const JoyBusDevice devices[] = { DEVICE_N64, DEVICE_GAMECUBE };
+        for( JoyBusDevice device : devices )
+        {
+            std::string command = "\"" + tool + "\" --device " + ( device == DEVICE_N64 ? "n64" : "gamecube" ) + " \"" + directory + "\" .";
+            std::fflush( stdout );
+            if( std::system( command.c_str() ) != 0 )
+            {
+                Fail( "batch", "the batch tool failed: " + command );
+                continue;
+            }
+
+            for( const Fixture& fixture : FIXTURES )
+            {
+                if( fixture.mDevice != device )
+                {
+                    continue;
+                }
+
+                std::string name = fixture.mName;
+                std::unique_ptr<GameCubeControllerCapture> capture( OpenFixture( directory + "/" + name + ".vcd" ) );
+                std::vector<std::string> expected, rows;
+                if( !capture || !ReadLines( directory + "/" + name + ".expected", expected ) || !ReadBatchRows( name + ".csv", rows ) )
+                {
+                    Fail( name, "the batch tool's csv can't be compared" );
+                    continue;
+                }
+                ComparePackets( name, "batch tool", FormatBatchRows( expected, capture->GetSampleRate() ), rows );
+            }
+        }
+
+        // the gamecube checkpoints of the first run are still there, so this only decodes the window. the
+        // full csvs are removed first to show they aren't written again
+        for( const Fixture& fixture : FIXTURES )
+        {
+            std::remove( ( std::string( fixture.mName ) + ".csv" ).c_str() );
+        }
+        std::string command = "\"" + tool + "\" --device gamecube --window " + BATCH_WINDOW + " \"" + directory + "\" .";
+        std::fflush( stdout );
+        if( std::system( command.c_str() ) != 0 )
+        {
+            Fail( "batch", "the batch tool failed: " + command );
+            return;
+        }
+
+        for( const Fixture& fixture : FIXTURES )
+        {
+            if( fixture.mDevice != DEVICE_GAMECUBE )
+            {
+                continue;
+            }
+
+            std::string name = fixture.mName;
+            std::unique_ptr<GameCubeControllerCapture> capture( OpenFixture( directory + "/" + name + ".vcd" ) );
+            std::vector<std::string> expected, rows;
+            if( !capture || !ReadLines( directory + "/" + name + ".expected", expected ) || !ReadBatchRows( name + ".window.csv", rows ) )
+            {
+                Fail( name, "the batch tool's window csv can't be compared" );
+                continue;
+            }
+            if( std::ifstream( ( name + ".csv" ).c_str() ) )
+            {
+                Fail( name, "the batch tool decoded the whole capture again for a window" );
+            }
+
+            double rate = capture->GetSampleRate();
+            U64 start_sample = static_cast<U64>( BATCH_WINDOW_START_S * rate );
+            U64 end_sample = static_cast<U64>( BATCH_WINDOW_END_S * rate );
+            expected = FilterPackets( expected, start_sample, end_sample );
+            ComparePackets( name, "batch tool window", FormatBatchRows( expected, capture->GetSampleRate() ), rows );
+        }
+    }
+
+    // checks the event index's lookups against a linear scan of the events it holds, and its button
+    // events against the states it was given. the states come from a fixed pseudo-random sequence with
+    // buttons held for a while, sticks wandering and a poll mode that leaves out the triggers
+    void CheckEventIndex( U64 window_samples )
+    {
+        std::string name = "event index" + std::string( window_samples != 0 ? " window" : "" );
+        GameCubeControllerEventIndex index;
+        index.Reset( 64, 128, window_samples );
+
+        std::vector<U64> samples;
+        std::vector<U16> buttons;
+        GameCubeControllerState state = {};
+        U32 seed = 1;
+        for( U32 i = 0; i < EVENT_INDEX_STATES; i++ )
+        {
+            seed = seed * 1103515245 + 12345;
+            U32 random = seed >> 8;
+            if( random % 8 == 0 )
+            {
+                state.mButtons[ ( random >> 3 ) % 2 ] ^= 1 << ( ( random >> 4 ) % 8 );
+            }
+            state.mAxes[ ( random >> 8 ) % AXIS_COUNT ] = static_cast<U8>( random >> 12 );
+            state.mAxesPresent = i % 3 == 0 ? 0x0F : 0xFF;
+
+            samples.push_back( i * 1000 + random % 500 );
+            buttons.push_back( static_cast<U16>( state.mButtons[ 0 ] | ( state.mButtons[ 1 ] << 8 ) ) );
+            index.AddState( samples.back(), state );
+        }
+
+        for( U32 input = 0; input < GameCubeControllerEventIndex::INPUT_COUNT; input++ )
+        {
+            for( int active = 0; active < 2; active++ )
+            {
+                std::string list = GameCubeControllerEventIndex::GetInputName( input );
+                list += active ? " active" : " inactive";
+                std::vector<U64> events;
+                index.GetEvents( input, active != 0, events );
+
+                if( input < BUTTON_COUNT )
+                {
+                    std::vector<U64> expected;
+                    for( U32 i = 1; i < samples.size(); i++ )
+                    {
+                        bool was_pressed = ( buttons[ i - 1 ] >> input ) & 1;
+                        bool pressed = ( buttons[ i ] >> input ) & 1;
+                        if( pressed != was_pressed && pressed == ( active != 0 ) &&
+                            ( window_samples == 0 || samples.back() - samples[ i ] <= window_samples ) )
+                        {
+                            expected.push_back( samples[ i ] );
+                        }
+                    }
+                    // the window is trimmed per list when an event is added, so a list can hold older events
+                    // than the newest sample allows, but never miss newer ones
+                    if( events.size() < expected.size() || !std::equal( expected.begin(), expected.end(), events.end() - expected.size() ) )
+                    {
+                        Fail( name, list + ": the events don't match the states" );
+                    }
+                }
+
+                U64 last_sample = samples.back() + 1000;
+                for( U64 sample = 0; sample <= last_sample; sample += 97 )
+                {
+                    std::vector<U64>::const_iterator next = events.begin();
+                    while( next != events.end() && *next < sample )
+                    {
+                        next++;
+                    }
+
+                    U64 found = 0;
+                    bool has_next = index.FindNext( input, active != 0, sample, found );
+                    if( has_next != ( next != events.end() ) || ( has_next && found != *next ) )
+                    {
+                        Fail( name, list + ": FindNext from " + std::to_string( sample ) + " doesn't match a scan" );
+                    }
+
+                    U64 end_sample = sample + sample % 20000;
+                    U64 count = 0;
+                    for( U64 event : events )
+                    {
+                        count += event >= sample && event < end_sample ? 1 : 0;
+                    }
+                    if( index.Count( input, active != 0, sample, end_sample ) != count )
+                    {
+                        Fail( name, list + ": Count from " + std::to_string( sample ) + " doesn't match a scan" );
+                    }
+                }
+            }
+        }
+    }
+
+    void CheckThroughput( const std::string& directory )
+    {
+        std::unique_ptr<GameCubeControllerCapture> capture( OpenFixture( directory + "/traffic.vcd" ) );
+        if( !capture )
+        {
+            return;
+        }
+
+        std::vector<U64> traffic;
+        BitState initial_bit_state = BIT_HIGH;
+        ReadAllEdges( *capture, traffic, initial_bit_state );
+        if( initial_bit_state != BIT_HIGH || traffic.size() % 2 != 0 )
+        {
+            Fail( "throughput", "traffic.vcd has to start and end high" );
+            return;
+        }
+
+        // back to back copies, each one starting where the last one ended
+        U64 span = traffic.back() + traffic.front();
+        std::vector<U64> edges;
+        edges.reserve( traffic.size() * THROUGHPUT_REPEATS );
+        for( U32 i = 0; i < THROUGHPUT_REPEATS; i++ )
+        {
+            for( U64 edge : traffic )
+            {
+                edges.push_back( i * span + edge );
+            }
+        }
+
+        MemoryCapture memory( edges, capture->GetSampleRate(), BIT_HIGH );
+        PacketSink sink;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        DecodeCapture( memory, DEVICE_GAMECUBE, sink );
+        double seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+
+        double edges_per_s = edges.size() / std::max( seconds, 1e-9 );
+        std::printf( "throughput: %.1f million edges/s, baseline %.1f\n", edges_per_s / 1e6, THROUGHPUT_BASELINE / 1e6 );
+        if( edges_per_s < THROUGHPUT_BASELINE )
+        {
+            Fail( "throughput", "decoding is slower than the baseline" );
+        }
+    }
+}
+
+int main( int argc, char* argv[] )
+{
+    if( argc < 2 )
+    {
+        std::printf( "usage: %s FIXTURES [--update] [--batch TOOL]\n", argv[ 0 ] );
+        return 2;
+    }
+
+    std::string directory = argv[ 1 ];
+    bool update = false;
+    std::string batch_tool;
+    for( int i = 2; i < argc; i++ )
+    {
+        if( std::strcmp( argv[ i ], "--update" ) == 0 )
+        {
+            update = true;
+        }
+        else if( std::strcmp( argv[ i ], "--batch" ) == 0 && i + 1 < argc )
+        {
+            batch_tool = argv[ ++i ];
+        }
+    }
+
+    for( const Fixture& fixture : FIXTURES )
+    {
+        CheckFixture( directory, fixture, update );
+    }
+    if( !batch_tool.empty() )
+    {
+        CheckBatch( directory, batch_tool );
+    }
+    CheckEventIndex( 0 );
+    CheckEventIndex( EVENT_INDEX_STATES * 250 );
+    CheckThroughput( directory );
+
+    if( gFailures != 0 )
+    {
+        std::printf( "%d failures\n", gFailures );
+        return 1;
+    }
+    return 0;
+}